@@ -24,6 +24,8 @@
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
 #include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Object/ObjectFile.h"
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
@@ -439,7 +441,11 @@ jit_compiler::~jit_compiler()
 void jit_compiler::add(std::unique_ptr<llvm::Module> module, const std::string& path)
 {
 	ObjectCache cache{path};
-	m_engine->setObjectCache(&cache);
+
+	if (!path.empty())
+	{
+		m_engine->setObjectCache(&cache);
+	}
 
 	const auto ptr = module.get();
 	m_engine->addModule(std::move(module));
@@ -455,7 +461,24 @@ void jit_compiler::add(std::unique_ptr<llvm::Module> module, const std::string&
 
 void jit_compiler::add(const std::string& path)
 {
-	m_engine->addObjectFile(std::move(llvm::object::ObjectFile::createObjectFile(*ObjectCache::load(path)).get()));
+	// Map object file into memory (the buffer is kept alive by the engine)
+	auto buf = llvm::MemoryBuffer::getFile(path, -1, false);
+
+	if (!buf)
+	{
+		LOG_ERROR(GENERAL, "LLVM: Failed to open object file %s (%s)", path, buf.getError().message());
+		return;
+	}
+
+	auto obj = llvm::object::ObjectFile::createObjectFile((*buf)->getMemBufferRef());
+
+	if (!obj)
+	{
+		LOG_ERROR(GENERAL, "LLVM: Invalid object file %s (%s)", path, llvm::toString(obj.takeError()));
+		return;
+	}
+
+	m_engine->addObjectFile(llvm::object::OwningBinary<llvm::object::ObjectFile>(std::move(*obj), std::move(*buf)));
 }
 
 void jit_compiler::fin()
@@ -49,7 +49,7 @@ public:
 		return m_context;
 	}
 
-	// Add module (path to obj cache dir)
+	// Add module (path to obj cache dir, empty path disables caching)
 	void add(std::unique_ptr<llvm::Module> module, const std::string& path);
 
 	// Add object (path to obj file)
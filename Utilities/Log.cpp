@@ -7,6 +7,11 @@
 #include "rpcs3_version.h"
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #ifdef _WIN32
 #define NOMINMAX
@@ -49,23 +54,65 @@ void fmt_class_string<logs::level>::format(std::string& out, u64 arg)
 
 namespace logs
 {
-	constexpr std::size_t s_log_size = 128 * 1024 * 1024;
+	// Ring buffer size (adaptive limits apply to the amount of data not written yet)
+	constexpr std::size_t s_log_size = 32 * 1024 * 1024;
 	constexpr std::size_t s_log_size_s = s_log_size / 2;
 	constexpr std::size_t s_log_size_t = s_log_size / 4 + s_log_size_s;
 	constexpr std::size_t s_log_size_e = s_log_size / 8 + s_log_size_t;
 	constexpr std::size_t s_log_size_f = s_log_size / 16 + s_log_size_e;
 
+	// Ring buffer chunk size (unit of completion tracking)
+	constexpr std::size_t s_log_chunk = 1024 * 1024;
+
+	// Log size after which the compressed segment is moved to old_logs/ and the plain log is restarted
+	constexpr u64 s_log_segment = 256 * 1024 * 1024;
+
+	// Max number of rotated segments kept in old_logs/ (the oldest ones are removed)
+	constexpr u32 s_log_segments = 8;
+
+	// Deflate output buffer size
+	constexpr std::size_t s_log_zbuf = 256 * 1024;
+
 	class file_writer
 	{
-		fs::file m_file;
+		fs::file m_file; // Plain text log
+		fs::file m_fout; // Compressed log
 		std::string m_name;
 
-#ifdef _WIN32
-		::HANDLE m_fmap;
-#endif
-		atomic_t<std::size_t> m_pos{0};
-		std::size_t m_size{0};
-		uchar* m_fptr{};
+		std::unique_ptr<uchar[]> m_fptr; // Ring buffer
+		std::unique_ptr<atomic_t<u32>[]> m_chunks; // Bytes copied to each chunk
+
+		atomic_t<u64> m_pos{0}; // Reserved by emitters
+		atomic_t<u64> m_done{0}; // Copied by emitters
+		atomic_t<u64> m_out{0}; // Written to the files
+
+		z_stream m_zs{};
+		std::unique_ptr<uchar[]> m_zbuf;
+		bool m_zinit = false;
+
+		u64 m_seg_size = 0; // Current segment size
+		u32 m_seg_first = 0; // Oldest rotated segment kept
+		u32 m_seg_count = 0; // Next rotated segment number
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::thread m_thread;
+		bool m_stop = false;
+
+		// Background thread: write and compress completed data
+		void run();
+
+		// Remove the oldest rotated segments exceeding s_log_segments
+		void prune();
+
+		// Write all completed data to the files
+		void flush();
+
+		// Write raw data to the plain and compressed logs
+		void write(const uchar* data, std::size_t size);
+
+		// Finish the compressed stream
+		void finish();
 
 	public:
 		file_writer(const std::string& name);
@@ -198,6 +245,358 @@ namespace logs
 			g_init = true;
 		}
 	}
+
+	// Binary log record (followed by arguments, prefix and text)
+	struct async_record
+	{
+		u32 size; // Full record size (8-aligned)
+		u32 argc; // Argument count (UINT32_MAX for padding)
+		channel* ch;
+		level sev;
+		u32 prefix_size;
+		u32 text_size;
+		u64 stamp;
+		const char* fmt; // nullptr if the text is already formatted
+		const fmt_type_info* sup;
+	};
+
+	constexpr u32 s_queue_size = 256 * 1024;
+
+	// Per-thread ring buffer of log records (single producer, single consumer)
+	struct async_queue
+	{
+		std::unique_ptr<u8[]> data{new u8[s_queue_size]};
+
+		atomic_t<u64> head{0}; // Written by producer
+		atomic_t<u64> tail{0}; // Written by consumer
+		atomic_t<bool> closed{false}; // Set on producer thread exit
+	};
+
+	// Owner of the producer queue (registered on first asynchronous message)
+	struct async_producer
+	{
+		async_queue* queue = nullptr;
+
+		~async_producer()
+		{
+			if (queue)
+			{
+				queue->closed = true;
+			}
+		}
+	};
+
+	static thread_local async_producer g_tls_producer;
+
+	// Set for the background thread (its own messages are written synchronously)
+	static thread_local bool g_tls_log_thread = false;
+
+	// Fast check for message::broadcast
+	atomic_t<bool> g_async{false};
+
+	class async_logger
+	{
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+
+		// All producer queues (deleted by the background thread after the owner exits)
+		std::vector<async_queue*> m_queues;
+
+		std::thread m_thread;
+
+		bool m_stop = false;
+
+		// Background thread entry point: format and write all pending messages in timestamp order
+		void run();
+
+	public:
+		~async_logger();
+
+		void start();
+
+		void stop();
+
+		// Store the message in the current thread's queue (returns false if it must be written synchronously)
+		bool push(const message& msg, u64 stamp, const std::string& prefix, const char* fmt, const fmt_type_info* sup, const u64* args, const std::string& text);
+	};
+
+	static async_logger& get_async()
+	{
+		// Use magic static (constructed after the main logger, so it's destroyed before)
+		static async_logger logger;
+		return logger;
+	}
+
+	void set_async(bool value)
+	{
+		if (value)
+		{
+			get_async().start();
+		}
+		else if (g_async)
+		{
+			get_async().stop();
+		}
+	}
+}
+
+logs::async_logger::~async_logger()
+{
+	stop();
+
+	for (auto queue : m_queues)
+	{
+		// Queues of running threads are leaked
+		if (queue->closed)
+		{
+			delete queue;
+		}
+	}
+}
+
+void logs::async_logger::start()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_thread.joinable())
+	{
+		m_stop = false;
+		m_thread = std::thread([this] { run(); });
+		g_async = true;
+	}
+}
+
+void logs::async_logger::stop()
+{
+	g_async = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+		m_cv.notify_all();
+	}
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+bool logs::async_logger::push(const message& msg, u64 stamp, const std::string& prefix, const char* fmt, const fmt_type_info* sup, const u64* args, const std::string& text)
+{
+	// Arguments are copied with the terminator slot
+	u32 argc = 0;
+
+	if (fmt)
+	{
+		while (sup[argc].fmt_string)
+		{
+			argc++;
+		}
+	}
+
+	const u64 need = ::align(sizeof(async_record) + (argc + 1) * sizeof(u64) + prefix.size() + text.size(), 8);
+
+	if (need > s_queue_size / 4)
+	{
+		return false;
+	}
+
+	auto& queue = g_tls_producer.queue;
+
+	if (!queue)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_stop)
+		{
+			return false;
+		}
+
+		queue = new async_queue;
+		m_queues.push_back(queue);
+	}
+
+	u64 pos = queue->head;
+
+	// Records are never split: skip the rest of the buffer if necessary
+	u64 pad = s_queue_size - pos % s_queue_size;
+
+	if (pad >= need)
+	{
+		pad = 0;
+	}
+
+	// Wait for free space
+	while (pos + pad + need - queue->tail > s_queue_size)
+	{
+		if (!g_async)
+		{
+			return false;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.notify_all();
+		m_cv.wait_for(lock, std::chrono::milliseconds(1));
+	}
+
+	if (pad)
+	{
+		const auto rec = reinterpret_cast<async_record*>(queue->data.get() + pos % s_queue_size);
+		rec->size = static_cast<u32>(pad);
+		rec->argc = UINT32_MAX;
+		pos += pad;
+	}
+
+	const auto ptr = queue->data.get() + pos % s_queue_size;
+	const auto rec = reinterpret_cast<async_record*>(ptr);
+	rec->size = static_cast<u32>(need);
+	rec->argc = argc;
+	rec->ch = msg.ch;
+	rec->sev = msg.sev;
+	rec->prefix_size = static_cast<u32>(prefix.size());
+	rec->text_size = static_cast<u32>(text.size());
+	rec->stamp = stamp;
+	rec->fmt = fmt;
+	rec->sup = sup;
+
+	auto out = ptr + sizeof(async_record);
+	std::memcpy(out, args, (argc + 1) * sizeof(u64));
+	out += (argc + 1) * sizeof(u64);
+	std::memcpy(out, prefix.data(), prefix.size());
+	out += prefix.size();
+	std::memcpy(out, text.data(), text.size());
+
+	// Publish the record
+	queue->head = pos + need;
+
+	if (UNLIKELY(msg.sev == level::fatal))
+	{
+		// Flush everything before the crash
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		while (queue->tail < pos + need && g_async)
+		{
+			m_cv.notify_all();
+			m_cv.wait_for(lock, std::chrono::milliseconds(1));
+		}
+	}
+
+	return true;
+}
+
+void logs::async_logger::run()
+{
+	g_tls_log_thread = true;
+
+	struct entry
+	{
+		u64 stamp;
+		const async_record* rec;
+	};
+
+	std::vector<entry> entries;
+	std::vector<std::pair<async_queue*, u64>> ends;
+	std::string prefix;
+	std::string text;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		const bool stop = m_stop;
+
+		entries.clear();
+		ends.clear();
+
+		// Collect published records from all queues
+		for (auto it = m_queues.begin(); it != m_queues.end();)
+		{
+			const auto queue = *it;
+			const bool closed = queue->closed;
+			const u64 head = queue->head;
+			u64 pos = queue->tail;
+
+			if (closed && pos == head)
+			{
+				delete queue;
+				it = m_queues.erase(it);
+				continue;
+			}
+
+			while (pos < head)
+			{
+				const auto rec = reinterpret_cast<const async_record*>(queue->data.get() + pos % s_queue_size);
+
+				if (rec->argc != UINT32_MAX)
+				{
+					entries.push_back({rec->stamp, rec});
+				}
+
+				pos += rec->size;
+			}
+
+			ends.emplace_back(queue, head);
+			it++;
+		}
+
+		if (entries.empty())
+		{
+			for (auto& end : ends)
+			{
+				end.first->tail = end.second;
+			}
+
+			if (stop)
+			{
+				break;
+			}
+
+			m_cv.wait_for(lock, std::chrono::milliseconds(5));
+			continue;
+		}
+
+		lock.unlock();
+
+		std::stable_sort(entries.begin(), entries.end(), [](const entry& a, const entry& b)
+		{
+			return a.stamp < b.stamp;
+		});
+
+		for (const auto& e : entries)
+		{
+			const auto rec = e.rec;
+			const auto args = reinterpret_cast<const u64*>(rec + 1);
+			const auto data = reinterpret_cast<const char*>(args + rec->argc + 1);
+
+			prefix.assign(data, rec->prefix_size);
+			text.clear();
+
+			if (rec->fmt)
+			{
+				fmt::raw_append(text, rec->fmt, rec->sup, args);
+			}
+			else
+			{
+				text.assign(data + rec->prefix_size, rec->text_size);
+			}
+
+			const message msg{rec->ch, rec->sev};
+
+			for (listener* lis = get_logger(); lis; lis = lis->m_next)
+			{
+				lis->log(rec->stamp, msg, prefix, text);
+			}
+		}
+
+		for (auto& end : ends)
+		{
+			end.first->tail = end.second;
+		}
+
+		lock.lock();
+		m_cv.notify_all();
+	}
 }
 
 logs::listener::~listener()
@@ -224,7 +623,7 @@ void logs::listener::add(logs::listener* _new)
 	}
 }
 
-void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, const u64* args)
+void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, const u64* args, bool by_value)
 {
 	// Get timestamp
 	const u64 stamp = get_stamp();
@@ -255,9 +654,31 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, const u
 
 	// Get text
 	thread_local std::string text; text.clear();
-	fmt::raw_append(text, fmt, sup, args);
 	std::string prefix = g_tls_log_prefix();
 
+	if (g_async && g_init && !g_tls_log_thread)
+	{
+		// Defer formatting if possible (pointer arguments may not outlive the call)
+		if (!by_value)
+		{
+			fmt::raw_append(text, fmt, sup, args);
+		}
+
+		if (get_async().push(*this, stamp, prefix, by_value ? fmt : nullptr, sup, args, text))
+		{
+			return;
+		}
+
+		if (by_value)
+		{
+			fmt::raw_append(text, fmt, sup, args);
+		}
+	}
+	else
+	{
+		fmt::raw_append(text, fmt, sup, args);
+	}
+
 	// Get first (main) listener
 	listener* lis = get_logger();
 
@@ -298,21 +719,49 @@ logs::file_writer::file_writer(const std::string& name)
 			fmt::throw_exception("Can't create file %s (error %s)", name, fs::g_tls_error);
 		}
 
-#ifdef _WIN32
-		m_fmap = CreateFileMappingW(m_file.get_handle(), 0, PAGE_READWRITE, s_log_size >> 32, s_log_size & 0xffffffff, 0);
-		m_fptr = m_fmap ? (uchar*)MapViewOfFile(m_fmap, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
-#else
-		m_file.trunc(s_log_size);
-		m_fptr = (uchar*)::mmap(0, s_log_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file.get_handle(), 0);
-#endif
-
-		verify(name.c_str()), m_fptr;
-		std::memset(m_fptr, '\n', s_log_size);
-
 		// Rotate backups (TODO)
 		fs::remove_file(fs::get_config_dir() + name + "1.gz");
 		fs::create_dir(fs::get_config_dir() + "old_logs");
 		fs::rename(fs::get_config_dir() + m_name + ".gz", fs::get_config_dir() + "old_logs/" + m_name + ".gz", true);
+
+		// Continue numbering after the segments rotated by the previous runs (old_logs/<name>.<n>.gz)
+		bool found = false;
+
+		for (const auto& entry : fs::dir(fs::get_config_dir() + "old_logs"))
+		{
+			if (entry.is_directory || entry.name.size() <= m_name.size() + 4 || entry.name.compare(0, m_name.size() + 1, m_name + '.') || entry.name.compare(entry.name.size() - 3, 3, ".gz"))
+			{
+				continue;
+			}
+
+			const std::string num = entry.name.substr(m_name.size() + 1, entry.name.size() - m_name.size() - 4);
+
+			if (num.size() > 9 || num.find_first_not_of("0123456789") != std::string::npos)
+			{
+				continue;
+			}
+
+			const u32 index = static_cast<u32>(std::stoul(num));
+
+			m_seg_first = found ? std::min(m_seg_first, index) : index;
+			m_seg_count = found ? std::max(m_seg_count, index + 1) : index + 1;
+			found = true;
+		}
+
+		prune();
+
+		if (!m_fout.open(fs::get_config_dir() + name + ".gz", fs::rewrite))
+		{
+			fmt::throw_exception("Can't create file %s.gz (error %s)", name, fs::g_tls_error);
+		}
+
+		m_fptr.reset(new uchar[s_log_size]);
+		m_chunks.reset(new atomic_t<u32>[s_log_size / s_log_chunk]());
+		m_zbuf.reset(new uchar[s_log_zbuf]);
+
+		m_zinit = deflateInit2(&m_zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + 15, 9, Z_DEFAULT_STRATEGY) == Z_OK;
+
+		m_thread = std::thread([this] { run(); });
 	}
 	catch (...)
 	{
@@ -322,38 +771,175 @@ logs::file_writer::file_writer(const std::string& name)
 
 logs::file_writer::~file_writer()
 {
-	if (m_size == 0)
 	{
-		m_size = std::min<std::size_t>(+m_pos, s_log_size);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+		m_cv.notify_all();
+	}
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
 	}
 
-	// Compress
-	z_stream zs{};
-	if (deflateInit2(&zs, 9, Z_DEFLATED, 16 + 15, 9, Z_DEFAULT_STRATEGY) == Z_OK)
+	flush();
+	finish();
+
+	if (m_zinit && deflateEnd(&m_zs) != Z_OK)
 	{
-		auto buf = std::make_unique<uchar[]>(s_log_size);
-		zs.avail_in  = ::narrow<u32>(m_size);
-		zs.avail_out = s_log_size;
-		zs.next_in   = m_fptr;
-		zs.next_out  = buf.get();
+	}
+}
 
-		if (deflate(&zs, Z_FINISH) != Z_STREAM_ERROR)
+void logs::file_writer::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		lock.unlock();
+		flush();
+		lock.lock();
+
+		if (!m_stop)
 		{
-			fs::file(fs::get_config_dir() + m_name + ".gz", fs::rewrite).write(buf.get(), zs.total_out);
+			m_cv.wait_for(lock, std::chrono::milliseconds(20));
 		}
+	}
+}
 
-		if (deflateEnd(&zs) != Z_OK)
+void logs::file_writer::flush()
+{
+	if (!m_fptr)
+	{
+		return;
+	}
+
+	const u64 out = m_out;
+
+	// Skip completed chunks
+	u64 end = out;
+
+	while (end - out < s_log_size && m_chunks[end / s_log_chunk % (s_log_size / s_log_chunk)] == s_log_chunk)
+	{
+		end = end / s_log_chunk * s_log_chunk + s_log_chunk;
+	}
+
+	// Take everything if no copy is in progress (m_done must be loaded first)
+	const u64 done = m_done;
+	const u64 pos = m_pos;
+
+	if (done == pos && pos > end)
+	{
+		end = pos;
+	}
+
+	if (end == out)
+	{
+		return;
+	}
+
+	for (u64 ptr = out; ptr < end;)
+	{
+		const std::size_t off = ptr % s_log_size;
+		const std::size_t size = std::min<u64>(end - ptr, s_log_size - off);
+		write(m_fptr.get() + off, size);
+		ptr += size;
+	}
+
+	// Release fully written chunks
+	for (u64 i = out / s_log_chunk; i < end / s_log_chunk; i++)
+	{
+		m_chunks[i % (s_log_size / s_log_chunk)] = 0;
+	}
+
+	m_out = end;
+}
+
+void logs::file_writer::write(const uchar* data, std::size_t size)
+{
+	m_file.write(data, size);
+
+	if (m_zinit)
+	{
+		m_zs.next_in  = const_cast<uchar*>(data);
+		m_zs.avail_in = ::narrow<u32>(size);
+
+		do
 		{
+			m_zs.next_out  = m_zbuf.get();
+			m_zs.avail_out = s_log_zbuf;
+
+			if (deflate(&m_zs, Z_NO_FLUSH) == Z_STREAM_ERROR)
+			{
+				break;
+			}
+
+			m_fout.write(m_zbuf.get(), s_log_zbuf - m_zs.avail_out);
 		}
+		while (m_zs.avail_out == 0);
 	}
 
-#ifdef _WIN32
-	UnmapViewOfFile(m_fptr);
-	CloseHandle(m_fmap);
-#else
-	::munmap(m_fptr, s_log_size);
-#endif
-	m_file.trunc(m_size);
+	m_seg_size += size;
+
+	if (m_seg_size >= s_log_segment)
+	{
+		// Move compressed segment to old_logs/ and restart both files
+		finish();
+		m_fout.close();
+
+		const std::string old_name = fmt::format("%sold_logs/%s.%u.gz", fs::get_config_dir(), m_name, m_seg_count++);
+		fs::rename(fs::get_config_dir() + m_name + ".gz", old_name, true);
+		m_fout.open(fs::get_config_dir() + m_name + ".gz", fs::rewrite);
+		prune();
+
+		if (m_zinit && deflateReset(&m_zs) != Z_OK)
+		{
+			m_zinit = false;
+		}
+
+		m_file.trunc(0);
+		m_file.seek(0);
+		m_seg_size = 0;
+	}
+}
+
+void logs::file_writer::prune()
+{
+	while (m_seg_count - m_seg_first > s_log_segments)
+	{
+		fs::remove_file(fmt::format("%sold_logs/%s.%u.gz", fs::get_config_dir(), m_name, m_seg_first++));
+	}
+}
+
+void logs::file_writer::finish()
+{
+	if (!m_zinit || !m_fout)
+	{
+		return;
+	}
+
+	m_zs.next_in  = nullptr;
+	m_zs.avail_in = 0;
+
+	while (true)
+	{
+		m_zs.next_out  = m_zbuf.get();
+		m_zs.avail_out = s_log_zbuf;
+
+		const int res = deflate(&m_zs, Z_FINISH);
+
+		if (res == Z_STREAM_ERROR)
+		{
+			break;
+		}
+
+		m_fout.write(m_zbuf.get(), s_log_zbuf - m_zs.avail_out);
+
+		if (res == Z_STREAM_END)
+		{
+			break;
+		}
+	}
 }
 
 void logs::file_writer::log(logs::level sev, const char* text, std::size_t size)
@@ -364,22 +950,40 @@ void logs::file_writer::log(logs::level sev, const char* text, std::size_t size)
 		sev == logs::level::todo ? s_log_size_t :
 		sev == logs::level::error ? s_log_size_e : s_log_size_f;
 
-	if (m_pos >= lim)
+	// Acquire memory (the message is dropped if the background thread can't keep up)
+	u64 pos;
+
+	while (true)
 	{
-		return;
-	}
+		pos = m_pos;
 
-	// Acquire memory
-	const auto pos = m_pos.fetch_add(size);
+		if (pos + size - m_out > lim || !m_fptr)
+		{
+			return;
+		}
 
-	// Write if possible
-	if (pos + size <= s_log_size)
+		if (m_pos.compare_and_swap_test(pos, pos + size))
+		{
+			break;
+		}
+	}
+
+	// Copy data, possibly wrapping around
+	for (std::size_t copied = 0; copied < size;)
 	{
-		std::memcpy(m_fptr + pos, text, size);
+		const u64 ptr = pos + copied;
+		const std::size_t off = ptr % s_log_size;
+		const std::size_t count = std::min<std::size_t>({size - copied, s_log_size - off, s_log_chunk - ptr % s_log_chunk});
+		std::memcpy(m_fptr.get() + off, text + copied, count);
+		m_chunks[ptr / s_log_chunk % (s_log_size / s_log_chunk)] += ::narrow<u32>(count);
+		copied += count;
 	}
-	else if (pos <= s_log_size)
+
+	m_done += size;
+
+	if (UNLIKELY(sev == logs::level::fatal))
 	{
-		m_size = pos;
+		m_cv.notify_all();
 	}
 }
 
@@ -4,6 +4,7 @@
 #include "Atomic.h"
 #include "StrFmt.h"
 #include <climits>
+#include <initializer_list>
 
 namespace logs
 {
@@ -23,22 +24,39 @@ namespace logs
 
 	struct channel;
 
+	class async_logger;
+
 	// Message information (temporary data)
 	struct message
 	{
 		channel* ch;
 		level sev;
 
-		// Send log message to global logger instance
-		void broadcast(const char*, const fmt_type_info*, const u64*);
+		// Send log message to global logger instance (formatting may be deferred if all arguments are passed by value)
+		void broadcast(const char*, const fmt_type_info*, const u64*, bool by_value = false);
 	};
 
+	// Check whether all formatting arguments are passed by value
+	template <typename... Args>
+	constexpr bool is_by_value()
+	{
+		bool result = true;
+
+		for (bool value : {true, (std::is_arithmetic<Args>::value || std::is_enum<Args>::value)...})
+		{
+			result = result && value;
+		}
+
+		return result;
+	}
+
 	class listener
 	{
 		// Next listener (linked list)
 		atomic_t<listener*> m_next{};
 
 		friend struct message;
+		friend class async_logger;
 
 	public:
 		constexpr listener() = default;
@@ -73,7 +91,7 @@ namespace logs
 		{
 			if (UNLIKELY(sev <= enabled))
 			{
-				message{this, sev}.broadcast(fmt, fmt::get_type_info<fmt_unveil_t<Args>...>(), fmt_args_t<Args...>{fmt_unveil<Args>::get(args)...});
+				message{this, sev}.broadcast(fmt, fmt::get_type_info<fmt_unveil_t<Args>...>(), fmt_args_t<Args...>{fmt_unveil<Args>::get(args)...}, is_by_value<fmt_unveil_t<Args>...>());
 			}
 		}
 
@@ -111,6 +129,9 @@ namespace logs
 
 	// Log level control: register channel if necessary, set channel level
 	void set_level(const std::string&, level);
+
+	// Enable or disable asynchronous logging (messages are formatted and written by a background thread)
+	void set_async(bool);
 }
 
 // Legacy:
@@ -283,6 +283,12 @@ public:
 		return m_thread.get();
 	}
 
+	// Get weak reference to thread_ctrl (may be notified after the object is destroyed)
+	std::weak_ptr<thread_ctrl> get_weak() const
+	{
+		return m_thread;
+	}
+
 	void join() const
 	{
 		return m_thread->join();
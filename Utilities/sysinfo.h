@@ -21,6 +21,17 @@ namespace utils
 		return get_cpuid(0, 0)[0] >= 0x1 && get_cpuid(1, 0)[2] & 0x200;
 	}
 
+	inline bool has_aes()
+	{
+		return get_cpuid(0, 0)[0] >= 0x1 && get_cpuid(1, 0)[2] & 0x2000000;
+	}
+
+	inline bool has_sha()
+	{
+		// Also check SSE4.1 which is required by the implementation
+		return get_cpuid(0, 0)[0] >= 0x7 && get_cpuid(7, 0)[1] & 0x20000000 && get_cpuid(1, 0)[2] & 0x80000;
+	}
+
 	inline bool has_avx()
 	{
 		return get_cpuid(0, 0)[0] >= 0x1 && get_cpuid(1, 0)[2] & 0x10000000;
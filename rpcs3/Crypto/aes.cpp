@@ -30,6 +30,7 @@
  */
 
 #include "aes.h"
+#include "Utilities/sysinfo.h"
 
 /*
  * 32-bit integer manipulation macros (little endian)
@@ -632,6 +633,178 @@ int aes_setkey_dec( aes_context *ctx, const unsigned char *key, unsigned int key
                  RT3[ ( Y0 >> 24 ) & 0xFF ];    \
 }
 
+/*
+ * AES-NI support (the round keys computed above are used as is:
+ * decryption keys are already transformed with InvMixColumns)
+ */
+#ifdef _MSC_VER
+#define AESNI_FUNC
+#else
+#define AESNI_FUNC __attribute__((__target__("aes,sse2")))
+#endif
+
+static bool aesni_supported( void )
+{
+    static const bool result = utils::has_aes();
+    return( result );
+}
+
+AESNI_FUNC static inline __m128i aesni_encrypt( const __m128i *rk, int nr, __m128i b )
+{
+    int i;
+
+    b = _mm_xor_si128( b, _mm_loadu_si128( rk ) );
+
+    for( i = 1; i < nr; i++ )
+        b = _mm_aesenc_si128( b, _mm_loadu_si128( rk + i ) );
+
+    return( _mm_aesenclast_si128( b, _mm_loadu_si128( rk + nr ) ) );
+}
+
+AESNI_FUNC static inline __m128i aesni_decrypt( const __m128i *rk, int nr, __m128i b )
+{
+    int i;
+
+    b = _mm_xor_si128( b, _mm_loadu_si128( rk ) );
+
+    for( i = 1; i < nr; i++ )
+        b = _mm_aesdec_si128( b, _mm_loadu_si128( rk + i ) );
+
+    return( _mm_aesdeclast_si128( b, _mm_loadu_si128( rk + nr ) ) );
+}
+
+/*
+ * Process 4 independent blocks at once to hide the instruction latency
+ */
+AESNI_FUNC static inline void aesni_crypt4( const __m128i *rk, int nr, int mode, __m128i b[4] )
+{
+    int i, j;
+    __m128i k = _mm_loadu_si128( rk );
+
+    for( j = 0; j < 4; j++ )
+        b[j] = _mm_xor_si128( b[j], k );
+
+    for( i = 1; i < nr; i++ )
+    {
+        k = _mm_loadu_si128( rk + i );
+
+        for( j = 0; j < 4; j++ )
+            b[j] = mode == AES_DECRYPT ? _mm_aesdec_si128( b[j], k ) : _mm_aesenc_si128( b[j], k );
+    }
+
+    k = _mm_loadu_si128( rk + nr );
+
+    for( j = 0; j < 4; j++ )
+        b[j] = mode == AES_DECRYPT ? _mm_aesdeclast_si128( b[j], k ) : _mm_aesenclast_si128( b[j], k );
+}
+
+AESNI_FUNC static void aesni_crypt_ecb( aes_context *ctx,
+                                        int mode,
+                                        const unsigned char input[16],
+                                        unsigned char output[16] )
+{
+    const __m128i *rk = (const __m128i *) ctx->rk;
+    const __m128i b = _mm_loadu_si128( (const __m128i *) input );
+
+    _mm_storeu_si128( (__m128i *) output, mode == AES_DECRYPT ? aesni_decrypt( rk, ctx->nr, b ) : aesni_encrypt( rk, ctx->nr, b ) );
+}
+
+AESNI_FUNC static void aesni_crypt_cbc( aes_context *ctx,
+                                        int mode,
+                                        size_t length,
+                                        unsigned char iv[16],
+                                        const unsigned char *input,
+                                        unsigned char *output )
+{
+    const __m128i *rk = (const __m128i *) ctx->rk;
+    __m128i v = _mm_loadu_si128( (const __m128i *) iv );
+    __m128i b[4], c[4];
+    int j;
+
+    if( mode == AES_DECRYPT )
+    {
+        while( length >= 64 )
+        {
+            for( j = 0; j < 4; j++ )
+                b[j] = c[j] = _mm_loadu_si128( (const __m128i *) input + j );
+
+            aesni_crypt4( rk, ctx->nr, AES_DECRYPT, b );
+
+            for( j = 0; j < 4; j++ )
+            {
+                _mm_storeu_si128( (__m128i *) output + j, _mm_xor_si128( b[j], v ) );
+                v = c[j];
+            }
+
+            input  += 64;
+            output += 64;
+            length -= 64;
+        }
+
+        while( length > 0 )
+        {
+            c[0] = _mm_loadu_si128( (const __m128i *) input );
+            _mm_storeu_si128( (__m128i *) output, _mm_xor_si128( aesni_decrypt( rk, ctx->nr, c[0] ), v ) );
+            v = c[0];
+
+            input  += 16;
+            output += 16;
+            length -= 16;
+        }
+    }
+    else
+    {
+        while( length > 0 )
+        {
+            v = aesni_encrypt( rk, ctx->nr, _mm_xor_si128( _mm_loadu_si128( (const __m128i *) input ), v ) );
+            _mm_storeu_si128( (__m128i *) output, v );
+
+            input  += 16;
+            output += 16;
+            length -= 16;
+        }
+    }
+
+    _mm_storeu_si128( (__m128i *) iv, v );
+}
+
+/*
+ * AES-CTR for whole groups of 4 blocks (returns the number of processed bytes)
+ */
+AESNI_FUNC static size_t aesni_crypt_ctr( aes_context *ctx,
+                                          size_t length,
+                                          unsigned char nonce_counter[16],
+                                          const unsigned char *input,
+                                          unsigned char *output )
+{
+    const __m128i *rk = (const __m128i *) ctx->rk;
+    const size_t total = length & ~(size_t) 63;
+    __m128i b[4];
+    int i, j;
+
+    for( length = total; length > 0; length -= 64 )
+    {
+        for( j = 0; j < 4; j++ )
+        {
+            b[j] = _mm_loadu_si128( (const __m128i *) nonce_counter );
+
+            for( i = 16; i > 0; i-- )
+                if( ++nonce_counter[i - 1] != 0 )
+                    break;
+        }
+
+        aesni_crypt4( rk, ctx->nr, AES_ENCRYPT, b );
+
+        for( j = 0; j < 4; j++ )
+            _mm_storeu_si128( (__m128i *) output + j, _mm_xor_si128( b[j], _mm_loadu_si128( (const __m128i *) input + j ) ) );
+
+        input  += 64;
+        output += 64;
+    }
+
+    return( total );
+}
+
 /*
  * AES-ECB block encryption/decryption
  */
@@ -643,6 +816,12 @@ int aes_crypt_ecb( aes_context *ctx,
     int i;
     uint32_t *RK, X0, X1, X2, X3, Y0, Y1, Y2, Y3;
 
+    if( aesni_supported() )
+    {
+        aesni_crypt_ecb( ctx, mode, input, output );
+        return( 0 );
+    }
+
     RK = ctx->rk;
 
     GET_UINT32_LE( X0, input,  0 ); X0 ^= *RK++;
@@ -743,6 +922,12 @@ int aes_crypt_cbc( aes_context *ctx,
     if( length % 16 )
         return( POLARSSL_ERR_AES_INVALID_INPUT_LENGTH );
 
+    if( aesni_supported() )
+    {
+        aesni_crypt_cbc( ctx, mode, length, iv, input, output );
+        return( 0 );
+    }
+
     if( mode == AES_DECRYPT )
     {
         while( length > 0 )
@@ -839,6 +1024,14 @@ int aes_crypt_ctr( aes_context *ctx,
     int c, i;
     size_t n = *nc_off;
 
+    if( n == 0 && aesni_supported() )
+    {
+        const size_t done = aesni_crypt_ctr( ctx, length, nonce_counter, input, output );
+        input  += done;
+        output += done;
+        length -= done;
+    }
+
     while( length-- )
     {
         if( n == 0 ) {
@@ -29,6 +29,7 @@
  */
  
 #include "sha1.h"
+#include "Utilities/sysinfo.h"
 
 /*
  * 32-bit integer manipulation macros (big endian)
@@ -68,10 +69,89 @@ void sha1_starts( sha1_context *ctx )
     ctx->state[4] = 0xC3D2E1F0;
 }
 
+/*
+ * SHA-NI support
+ */
+#ifdef _MSC_VER
+#define SHANI_FUNC
+#else
+#define SHANI_FUNC __attribute__((__target__("sha,sse4.1,ssse3")))
+#endif
+
+static bool shani_supported( void )
+{
+    static const bool result = utils::has_sha();
+    return( result );
+}
+
+/*
+ * Process 4 rounds of group i (rounds 4i..4i+3) and schedule the message words
+ */
+#define SHANI_GROUP(i)                                                              \
+{                                                                                   \
+    E = (i) == 0 ? _mm_add_epi32( E_NEXT, MSG[0] )                                  \
+                 : _mm_sha1nexte_epu32( E_NEXT, MSG[(i) & 3] );                     \
+    E_NEXT = ABCD;                                                                  \
+                                                                                    \
+    if( (i) >= 3 && (i) <= 18 )                                                     \
+        MSG[((i) + 1) & 3] = _mm_sha1msg2_epu32( MSG[((i) + 1) & 3], MSG[(i) & 3] );\
+                                                                                    \
+    ABCD = _mm_sha1rnds4_epu32( ABCD, E, (i) / 5 );                                 \
+                                                                                    \
+    if( (i) >= 1 && (i) <= 16 )                                                     \
+        MSG[((i) - 1) & 3] = _mm_sha1msg1_epu32( MSG[((i) - 1) & 3], MSG[(i) & 3] );\
+                                                                                    \
+    if( (i) >= 2 && (i) <= 17 )                                                     \
+        MSG[((i) - 2) & 3] = _mm_xor_si128( MSG[((i) - 2) & 3], MSG[(i) & 3] );     \
+}
+
+SHANI_FUNC static void shani_process( sha1_context *ctx, const unsigned char *data, size_t blocks )
+{
+    const __m128i MASK = _mm_set_epi64x( 0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL );
+    __m128i ABCD, ABCD_SAVE, E0, E0_SAVE, E, E_NEXT, MSG[4];
+    int i;
+
+    ABCD = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i *) ctx->state ), 0x1B );
+    E0 = _mm_set_epi32( ctx->state[4], 0, 0, 0 );
+
+    while( blocks-- )
+    {
+        ABCD_SAVE = ABCD;
+        E0_SAVE = E0;
+
+        for( i = 0; i < 4; i++ )
+            MSG[i] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *) data + i ), MASK );
+
+        E_NEXT = E0;
+
+        SHANI_GROUP(  0 ); SHANI_GROUP(  1 ); SHANI_GROUP(  2 ); SHANI_GROUP(  3 );
+        SHANI_GROUP(  4 ); SHANI_GROUP(  5 ); SHANI_GROUP(  6 ); SHANI_GROUP(  7 );
+        SHANI_GROUP(  8 ); SHANI_GROUP(  9 ); SHANI_GROUP( 10 ); SHANI_GROUP( 11 );
+        SHANI_GROUP( 12 ); SHANI_GROUP( 13 ); SHANI_GROUP( 14 ); SHANI_GROUP( 15 );
+        SHANI_GROUP( 16 ); SHANI_GROUP( 17 ); SHANI_GROUP( 18 ); SHANI_GROUP( 19 );
+
+        E0 = _mm_sha1nexte_epu32( E_NEXT, E0_SAVE );
+        ABCD = _mm_add_epi32( ABCD, ABCD_SAVE );
+
+        data += 64;
+    }
+
+    _mm_storeu_si128( (__m128i *) ctx->state, _mm_shuffle_epi32( ABCD, 0x1B ) );
+    ctx->state[4] = _mm_extract_epi32( E0, 3 );
+}
+
+#undef SHANI_GROUP
+
 void sha1_process( sha1_context *ctx, const unsigned char data[64] )
 {
     uint32_t temp, W[16], A, B, C, D, E;
 
+    if( shani_supported() )
+    {
+        shani_process( ctx, data, 1 );
+        return;
+    }
+
     GET_UINT32_BE( W[ 0], data,  0 );
     GET_UINT32_BE( W[ 1], data,  4 );
     GET_UINT32_BE( W[ 2], data,  8 );
@@ -254,6 +334,13 @@ void sha1_update( sha1_context *ctx, const unsigned char *input, size_t ilen )
         left = 0;
     }
 
+    if( ilen >= 64 && shani_supported() )
+    {
+        shani_process( ctx, input, ilen / 64 );
+        input += ilen & ~(size_t) 63;
+        ilen  &= 63;
+    }
+
     while( ilen >= 64 )
     {
         sha1_process( ctx, input );
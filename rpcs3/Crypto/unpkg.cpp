@@ -7,6 +7,11 @@
 #include "Emu/VFS.h"
 #include "unpkg.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
 bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>& sync, const std::string& pkg_filepath)
 {
 	const std::size_t BUF_SIZE = 8192 * 1024; // 8 MB
@@ -187,16 +192,11 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 	// Allocate buffer with BUF_SIZE size or more if required
 	const std::unique_ptr<u128[]> buf(new u128[std::max<u64>(BUF_SIZE, sizeof(PKGEntry) * header.file_count) / sizeof(u128)]);
 
-	// Define decryption subfunction (`psp` arg selects the key for specific block)
-	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	// Define decryption subfunction for the data at specified position (thread-safe, every 16-byte block is independent)
+	auto decrypt_data = [&](u128* data, u64 offset, u64 size, const uchar* key)
 	{
-		archive_seek(start_offset + header.data_offset + offset);
-
-		// Read the data and set available size
-		const u64 read = archive_read(buf.get(), size);
-
 		// Get block count
-		const u64 blocks = (read + 15) / 16;
+		const u64 blocks = (size + 15) / 16;
 
 		if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
 		{
@@ -222,7 +222,7 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 				
 				sha1(reinterpret_cast<const u8*>(input), sizeof(input), hash.data);
 
-				buf[i] ^= hash._v128;
+				data[i] ^= hash._v128;
 			}
 		}
 
@@ -233,22 +233,164 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 			// Set encryption key for stream cipher
 			aes_setkey_enc(&ctx, key, 128);
 
-			// Initialize stream cipher for start position
+			// Initialize stream cipher for start position (big-endian counter incremented for every block)
 			be_t<u128> input = header.klicensee.value() + offset / 16;
 
-			// Increment stream position for every block
-			for (u64 i = 0; i < blocks; i++, input++)
+			u8 stream[16];
+			std::size_t stream_pos = 0;
+
+			aes_crypt_ctr(&ctx, blocks * 16, &stream_pos, reinterpret_cast<u8*>(&input), stream, reinterpret_cast<const u8*>(data), reinterpret_cast<u8*>(data));
+		}
+	};
+
+	// Define decryption subfunction (`psp` arg selects the key for specific block)
+	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	{
+		archive_seek(start_offset + header.data_offset + offset);
+
+		// Read the data and set available size
+		const u64 read = archive_read(buf.get(), size);
+
+		decrypt_data(buf.get(), offset, read, key);
+
+		// Return the amount of data written in buf
+		return read;
+	};
+
+	// File data block being decrypted and written by the worker pool
+	struct pkg_block
+	{
+		u128* data;
+		fs::file* out;
+		u64 pos; // Position in the output file
+		u64 offset; // Position in the package data
+		u64 size;
+		u64 part_size;
+		const uchar* key;
+		u64 parts = 0; // Parts not decrypted yet
+		bool busy = false; // Set until the block is written
+	};
+
+	// Blocks in flight: the next block is read while the previous ones are decrypted and written
+	const std::size_t block_count = 3;
+	const std::unique_ptr<u128[]> block_buf(new u128[BUF_SIZE / sizeof(u128) * block_count]);
+	std::array<pkg_block, block_count> blocks{};
+
+	std::mutex pool_mutex;
+	std::mutex write_mutex;
+	std::condition_variable pool_cv; // Signalled when a task is queued or the pool is stopped
+	std::condition_variable done_cv; // Signalled when a block is written
+	std::deque<std::pair<pkg_block*, u64>> tasks; // Block and part position
+	bool pool_stop = false;
+	bool write_ok = true;
+
+	// Worker pool (created once per package, parts are at least 256 KiB)
+	const u64 max_workers = std::max<u64>(std::thread::hardware_concurrency(), 1);
+
+	std::vector<std::thread> workers;
+
+	auto worker_task = [&]()
+	{
+		std::unique_lock<std::mutex> lock(pool_mutex);
+
+		while (true)
+		{
+			if (tasks.empty())
 			{
-				u128 key;
+				if (pool_stop)
+				{
+					return;
+				}
+
+				pool_cv.wait(lock);
+				continue;
+			}
+
+			const auto task = tasks.front();
+			tasks.pop_front();
+			lock.unlock();
 
-				aes_crypt_ecb(&ctx, AES_ENCRYPT, reinterpret_cast<const u8*>(&input), reinterpret_cast<u8*>(&key));
+			pkg_block& block = *task.first;
+			decrypt_data(block.data + task.second / 16, block.offset + task.second, std::min<u64>(block.part_size, block.size - task.second), block.key);
 
-				buf[i] ^= key;
+			lock.lock();
+
+			if (--block.parts)
+			{
+				continue;
 			}
+
+			// The last decrypted part writes the whole block
+			lock.unlock();
+
+			bool ok;
+			{
+				std::lock_guard<std::mutex> wlock(write_mutex);
+				block.out->seek(block.pos);
+				ok = block.out->write(block.data, block.size) == block.size;
+			}
+
+			lock.lock();
+			write_ok = write_ok && ok;
+			block.busy = false;
+			done_cv.notify_all();
 		}
+	};
 
-		// Return the amount of data written in buf
-		return read;
+	auto stop_workers = gsl::finally([&]()
+	{
+		{
+			std::lock_guard<std::mutex> lock(pool_mutex);
+			pool_stop = true;
+			pool_cv.notify_all();
+		}
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+	});
+
+	// Queue block for decryption and writing (the block must not be busy)
+	auto queue_block = [&](pkg_block& block)
+	{
+		const u64 parts = std::min<u64>(max_workers, block.size / 0x40000 + 1);
+		block.part_size = ::align(block.size / parts, 16);
+
+		std::lock_guard<std::mutex> lock(pool_mutex);
+
+		block.busy = true;
+
+		for (u64 pos = 0; pos < block.size; pos += block.part_size)
+		{
+			tasks.emplace_back(&block, pos);
+			block.parts++;
+		}
+
+		if (workers.empty())
+		{
+			for (u64 i = 0; i < max_workers; i++)
+			{
+				workers.emplace_back(worker_task);
+			}
+		}
+
+		pool_cv.notify_all();
+	};
+
+	// Wait until all queued blocks are written, return false on write error
+	auto wait_blocks = [&]()
+	{
+		std::unique_lock<std::mutex> lock(pool_mutex);
+
+		while (std::any_of(blocks.begin(), blocks.end(), [](const pkg_block& block) { return block.busy; }))
+		{
+			done_cv.wait(lock);
+		}
+
+		const bool result = write_ok;
+		write_ok = true;
+		return result;
 	};
 
 	std::array<uchar, 16> dec_key;
@@ -316,29 +458,60 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 
 			if (fs::file out{path, fs::rewrite})
 			{
-				for (u64 pos = 0; pos < entry.file_size; pos += BUF_SIZE)
+				// Preallocate the file
+				out.trunc(entry.file_size);
+
+				bool read_ok = true;
+
+				for (u64 pos = 0, i = 0; pos < entry.file_size; pos += BUF_SIZE, i++)
 				{
-					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
+					pkg_block& block = blocks[i % block_count];
 
-					if (decrypt(entry.file_offset + pos, block_size, is_psp ? PKG_AES_KEY2 : dec_key.data()) != block_size)
+					// Wait until the block used before is written
 					{
-						LOG_ERROR(LOADER, "Failed to extract file %s", path);
-						break;
+						std::unique_lock<std::mutex> lock(pool_mutex);
+
+						while (block.busy)
+						{
+							done_cv.wait(lock);
+						}
 					}
 
-					if (out.write(buf.get(), block_size) != block_size)
+					block.data = block_buf.get() + BUF_SIZE / sizeof(u128) * (i % block_count);
+					block.out = &out;
+					block.pos = pos;
+					block.offset = entry.file_offset + pos;
+					block.size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
+					block.key = is_psp ? PKG_AES_KEY2 : dec_key.data();
+
+					archive_seek(start_offset + header.data_offset + entry.file_offset + pos);
+
+					if (archive_read(block.data, block.size) != block.size)
 					{
-						LOG_ERROR(LOADER, "Failed to write file %s", path);
+						read_ok = false;
 						break;
 					}
 
-					if (sync.fetch_add((block_size + 0.0) / header.data_size) < 0.)
+					queue_block(block);
+
+					if (sync.fetch_add((block.size + 0.0) / header.data_size) < 0.)
 					{
+						wait_blocks();
 						LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
 						return false;
 					}
 				}
 
+				if (!wait_blocks())
+				{
+					LOG_ERROR(LOADER, "Failed to write file %s", path);
+				}
+
+				if (!read_ok)
+				{
+					LOG_ERROR(LOADER, "Failed to extract file %s", path);
+				}
+
 				if (did_overwrite)
 				{
 					LOG_WARNING(LOADER, "Overwritten file %s", name);
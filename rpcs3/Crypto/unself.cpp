@@ -1243,22 +1243,19 @@ bool SELFDecrypter::DecryptData()
 				memcpy(data_key, data_keys.get() + meta_shdr[i].key_idx * 0x10, 0x10);
 				memcpy(data_iv, data_keys.get() + meta_shdr[i].iv_idx * 0x10, 0x10);
 
-				// Allocate a buffer to hold the data.
-				auto buf = std::make_unique<u8[]>(meta_shdr[i].data_size);
+				// Decrypt in place (no intermediate buffer).
+				u8* const buf = data_buf.get() + data_buf_offset;
 
 				// Seek to the section data offset and read the encrypted data.
 				self_f.seek(meta_shdr[i].data_offset);
-				self_f.read(buf.get(), meta_shdr[i].data_size);
+				self_f.read(buf, meta_shdr[i].data_size);
 
 				// Zero out our ctr nonce.
 				memset(ctr_stream_block, 0, sizeof(ctr_stream_block));
 
 				// Perform AES-CTR encryption on the data blocks.
 				aes_setkey_enc(&aes, data_key, 128);
-				aes_crypt_ctr(&aes, meta_shdr[i].data_size, &ctr_nc_off, data_iv, ctr_stream_block, buf.get(), buf.get());
-
-				// Copy the decrypted data.
-				memcpy(data_buf.get() + data_buf_offset, buf.get(), meta_shdr[i].data_size);
+				aes_crypt_ctr(&aes, meta_shdr[i].data_size, &ctr_nc_off, data_iv, ctr_stream_block, buf, buf);
 
 				// Advance the buffer's offset.
 				data_buf_offset += meta_shdr[i].data_size;
@@ -1271,8 +1268,34 @@ bool SELFDecrypter::DecryptData()
 
 fs::file SELFDecrypter::MakeElf(bool isElf32)
 {
+	// Reserve memory for the resulting ELF file to avoid reallocations.
+	u64 elf_size = 0;
+
+	if (isElf32)
+	{
+		elf_size = elf32_hdr.e_shoff + u64{elf32_hdr.e_shnum} * elf32_hdr.e_shentsize;
+
+		for (const auto& phdr : phdr32_arr)
+		{
+			elf_size = std::max<u64>(elf_size, u64{phdr.p_offset} + phdr.p_filesz);
+		}
+	}
+	else
+	{
+		elf_size = elf64_hdr.e_shoff + u64{elf64_hdr.e_shnum} * elf64_hdr.e_shentsize;
+
+		for (const auto& phdr : phdr64_arr)
+		{
+			elf_size = std::max<u64>(elf_size, phdr.p_offset + phdr.p_filesz);
+		}
+	}
+
+	std::vector<u8> elf_buf;
+	elf_buf.reserve(elf_size);
+
 	// Create a new ELF file.
-	fs::file e = fs::make_stream<std::vector<u8>>();
+
+	fs::file e = fs::make_stream(std::move(elf_buf));
 
 	// Set initial offset.
 	u32 data_buf_offset = 0;
@@ -1340,13 +1363,9 @@ fs::file SELFDecrypter::MakeElf(bool isElf32)
 					/// Create a pointer to a buffer for decompression.
 					std::unique_ptr<u8[]> decomp_buf(new u8[phdr64_arr[meta_shdr[i].program_idx].p_filesz]);
 
-					// Create a buffer separate from data_buf to uncompress.
-					std::unique_ptr<u8[]> zlib_buf(new u8[data_buf_length]);
-					memcpy(zlib_buf.get(), data_buf.get(), data_buf_length);
-
-					// Use zlib uncompress on the new buffer.
+					// Use zlib uncompress directly on the section data.
 					// decomp_buf_length changes inside the call to uncompress, so it must be a pointer to correct type (in writeable mem space).
-					int rv = uncompress(decomp_buf.get(), decomp_buf_length.get(), zlib_buf.get() + data_buf_offset, data_buf_length);
+					int rv = uncompress(decomp_buf.get(), decomp_buf_length.get(), data_buf.get() + data_buf_offset, meta_shdr[i].data_size);
 
 					// Check for errors (TODO: Probably safe to remove this once these changes have passed testing.)
 					switch (rv)
@@ -155,18 +155,24 @@ void mfc_thread::cpu_task()
 							_xabort(0);
 						}
 
+						if (vm::reservation_acquire(cmd.eal, 128) & 1)
+						{
+							// The lock line is being updated
+							_xabort(0);
+						}
+
 						data = to_write;
 						vm::reservation_update(cmd.eal, 128);
-						vm::notify(cmd.eal, 128);
 						_xend();
 					}
 					else
 					{
-						vm::writer_lock lock(0);
+						vm::reservation_lock(cmd.eal, 128);
 						data = to_write;
 						vm::reservation_update(cmd.eal, 128);
-						vm::notify(cmd.eal, 128);
 					}
+
+					vm::notify(cmd.eal, 128);
 				}
 				else if (cmd.cmd & MFC_LIST_MASK)
 				{
@@ -2,6 +2,8 @@
 #include "PPUOpcodes.h"
 #include "PPUModule.h"
 #include "PPUAnalyser.h"
+#include "Emu/System.h"
+#include "Crypto/sha1.h"
 
 #include <unordered_set>
 
@@ -35,6 +37,303 @@ void fmt_class_string<bs_t<ppu_attr>>::format(std::string& out, u64 arg)
 	format_bitset(out, arg, "[", ",", "]", &fmt_class_string<ppu_attr>::format);
 }
 
+// Cache index file signature: "PPUIDX" and version (increment when the format or the analyser changes)
+static const u64 s_ppu_index_magic = 0x5050554944580002;
+
+ppu_cache_index::ppu_cache_index()
+{
+	const fs::file file(Emu.GetCachePath() + "ppu.idx");
+
+	if (!file)
+	{
+		return;
+	}
+
+	const std::string data = file.to_string();
+
+	std::size_t pos = 0;
+
+	auto read = [&](auto& value) -> bool
+	{
+		if (data.size() - pos < sizeof(value))
+		{
+			return false;
+		}
+
+		std::memcpy(&value, data.data() + pos, sizeof(value));
+		pos += sizeof(value);
+		return true;
+	};
+
+	auto read_str = [&](std::string& str) -> bool
+	{
+		u32 size;
+
+		if (!read(size) || data.size() - pos < size)
+		{
+			return false;
+		}
+
+		str.assign(data, pos, size);
+		pos += size;
+		return true;
+	};
+
+	u64 magic;
+
+	if (!read(magic) || magic != s_ppu_index_magic)
+	{
+		LOG_WARNING(PPU, "PPU cache index is outdated and will be rebuilt");
+		return;
+	}
+
+	std::string key;
+
+	while (pos < data.size())
+	{
+		entry e;
+		u32 nfuncs, nparts;
+
+		if (!read_str(key) || !read(nfuncs))
+		{
+			break;
+		}
+
+		bool ok = true;
+
+		for (u32 i = 0; ok && i < nfuncs; i++)
+		{
+			ppu_function func;
+			u32 nblocks;
+
+			ok = read(func.addr) && read(func.toc) && read(func.size) && read(nblocks);
+
+			for (u32 j = 0; ok && j < nblocks; j++)
+			{
+				u32 addr, size;
+				ok = read(addr) && read(size);
+				func.blocks.emplace_hint(func.blocks.end(), addr, size);
+			}
+
+			e.funcs.emplace_back(std::move(func));
+		}
+
+		ok = ok && read(nparts);
+
+		for (u32 i = 0; ok && i < nparts; i++)
+		{
+			part_info part;
+			ok = read(part.suffix) && read_str(part.obj_name);
+			e.parts.emplace_back(std::move(part));
+		}
+
+		if (!ok)
+		{
+			LOG_ERROR(PPU, "PPU cache index is damaged (pos=0x%x)", pos);
+			break;
+		}
+
+		m_map[key] = std::move(e);
+	}
+
+	LOG_NOTICE(PPU, "PPU cache index: %u modules", m_map.size());
+}
+
+void ppu_cache_index::write()
+{
+	std::string data;
+
+	auto put = [&](const auto& value)
+	{
+		data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+
+	auto put_str = [&](const std::string& str)
+	{
+		put(::size32(str));
+		data += str;
+	};
+
+	put(s_ppu_index_magic);
+
+	for (const auto& pair : m_map)
+	{
+		put_str(pair.first);
+		put(::size32(pair.second.funcs));
+
+		for (const auto& func : pair.second.funcs)
+		{
+			put(func.addr);
+			put(func.toc);
+			put(func.size);
+			put(::size32(func.blocks));
+
+			for (const auto& block : func.blocks)
+			{
+				put(block.first);
+				put(block.second);
+			}
+		}
+
+		put(::size32(pair.second.parts));
+
+		for (const auto& part : pair.second.parts)
+		{
+			put(part.suffix);
+			put_str(part.obj_name);
+		}
+	}
+
+	// Write to temporary file first
+	const std::string path = Emu.GetCachePath() + "ppu.idx";
+
+	if (fs::file tmp{path + ".tmp", fs::rewrite})
+	{
+		tmp.write(data);
+	}
+	else
+	{
+		LOG_ERROR(PPU, "Failed to write PPU cache index: %s (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	if (!fs::rename(path + ".tmp", path, true))
+	{
+		LOG_ERROR(PPU, "Failed to rename PPU cache index: %s (%s)", path, fs::g_tls_error);
+	}
+}
+
+std::string ppu_cache_index::get_key(const ppu_module& info)
+{
+	fs::stat_t stat;
+
+	if (info.path.empty() || !fs::stat(info.path, stat) || stat.is_directory)
+	{
+		return {};
+	}
+
+	std::string key = fmt::format("%s|%llx|%llx", info.path, stat.size, stat.mtime);
+
+	// Analysis results contain absolute addresses
+	for (const auto& seg : info.segs)
+	{
+		fmt::append(key, "|%x:%x", seg.addr, seg.size);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto& code_hash = m_code_hashes[key];
+
+	if (code_hash.empty())
+	{
+		// Hash loaded code (after patches are applied), computed once per module
+		sha1_context ctx;
+		u8 output[20];
+		sha1_starts(&ctx);
+
+		for (const auto& seg : info.segs)
+		{
+			if (seg.flags & 0x1 && seg.size)
+			{
+				sha1_update(&ctx, static_cast<const u8*>(vm::base(seg.addr)), seg.size);
+			}
+		}
+
+		sha1_finish(&ctx, output);
+
+		for (u8 byte : output)
+		{
+			fmt::append(code_hash, "%02x", byte);
+		}
+	}
+
+	return key + '|' + code_hash;
+}
+
+bool ppu_cache_index::load(ppu_module& info)
+{
+	const std::string key = get_key(info);
+
+	if (key.empty())
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto found = m_map.find(key);
+
+	if (found == m_map.end() || found->second.funcs.empty())
+	{
+		return false;
+	}
+
+	info.funcs = found->second.funcs;
+
+	LOG_SUCCESS(PPU, "Function analysis: %zu functions loaded from the cache index", info.funcs.size());
+	return true;
+}
+
+std::vector<ppu_cache_index::part_info> ppu_cache_index::get_parts(const ppu_module& info)
+{
+	const std::string key = get_key(info);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto found = m_map.find(key);
+
+	if (key.empty() || found == m_map.end())
+	{
+		return {};
+	}
+
+	return found->second.parts;
+}
+
+void ppu_cache_index::save(const ppu_module& info, const std::vector<part_info>& parts)
+{
+	const std::string key = get_key(info);
+
+	if (key.empty() || info.funcs.empty())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto& e = m_map[key];
+
+	bool changed = false;
+
+	if (e.funcs.size() != info.funcs.size())
+	{
+		e.funcs.clear();
+
+		for (const auto& func : info.funcs)
+		{
+			ppu_function copy;
+			copy.addr = func.addr;
+			copy.toc = func.toc;
+			copy.size = func.size;
+			copy.blocks = func.blocks;
+			e.funcs.emplace_back(std::move(copy));
+		}
+
+		changed = true;
+	}
+
+	if (!parts.empty() && parts != e.parts)
+	{
+		e.parts = parts;
+		changed = true;
+	}
+
+	if (changed)
+	{
+		write();
+	}
+}
+
 void ppu_module::validate(u32 reloc)
 {
 	// Load custom PRX configuration if available
@@ -3,6 +3,9 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
 
 #include "Utilities/bit_set.h"
 #include "Utilities/BEType.h"
@@ -78,6 +81,56 @@ struct ppu_module
 	void validate(u32 reloc);
 };
 
+// PPU cache index (per title): analysis results and object files of each module, allows to skip analysis and hashing
+class ppu_cache_index
+{
+public:
+	// Compiled module part
+	struct part_info
+	{
+		u32 suffix; // Symbol suffix (__mptr%x etc)
+		std::string obj_name; // Object file name in the module cache directory
+
+		bool operator ==(const part_info& rhs) const
+		{
+			return suffix == rhs.suffix && obj_name == rhs.obj_name;
+		}
+	};
+
+private:
+	struct entry
+	{
+		std::vector<ppu_function> funcs; // Only addr, toc, size and blocks are stored
+		std::vector<part_info> parts;
+	};
+
+	std::mutex m_mutex;
+
+	// Module identity -> cached data
+	std::unordered_map<std::string, entry> m_map;
+
+	// Module identity without code hash -> code hash
+	std::unordered_map<std::string, std::string> m_code_hashes;
+
+	// Rewrite the index file
+	void write();
+
+public:
+	ppu_cache_index();
+
+	// Get module identity (path, file size and modification time, segments, hash of the patched code), empty if the module can't be cached
+	std::string get_key(const ppu_module& info);
+
+	// Restore analysis results (returns false if the module is not cached)
+	bool load(ppu_module& info);
+
+	// Get compiled module parts (empty if not cached)
+	std::vector<part_info> get_parts(const ppu_module& info);
+
+	// Store analysis results and compiled module parts (if not empty)
+	void save(const ppu_module& info, const std::vector<part_info>& parts);
+};
+
 // Aux
 struct ppu_pattern
 {
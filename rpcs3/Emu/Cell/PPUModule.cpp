@@ -901,6 +901,9 @@ std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::stri
 		}
 	}
 
+	prx->name = path.substr(path.find_last_of('/') + 1);
+	prx->path = path;
+
 	if (!elf.progs.empty() && elf.progs[0].p_paddr)
 	{
 		struct ppu_prx_library_info
@@ -929,7 +932,11 @@ std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::stri
 		prx->specials = ppu_load_exports(link, lib_info->exports_start, lib_info->exports_end);
 		prx->imports = ppu_load_imports(prx->relocs, link, lib_info->imports_start, lib_info->imports_end);
 
-		prx->analyse(lib_info->toc, 0);
+		// Analyse library (or restore analysis results from the cache index)
+		if (!fxm::get_always<ppu_cache_index>()->load(*prx))
+		{
+			prx->analyse(lib_info->toc, 0);
+		}
 	}
 	else
 	{
@@ -941,8 +948,6 @@ std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::stri
 	prx->exit.set(prx->specials[0x3ab9a95e]);
 	prx->prologue.set(prx->specials[0x0D10FD3F]);
 	prx->epilogue.set(prx->specials[0x330F7005]);
-	prx->name = path.substr(path.find_last_of('/') + 1);
-	prx->path = path;
 
 	if (Emu.IsReady() && fxm::import<ppu_module>([&] { return prx; }))
 	{
@@ -988,6 +993,40 @@ void ppu_unload_prx(const lv2_prx& prx)
 	}
 }
 
+// Decrypt LLE module or load it from the cache (decrypted once for every version of the file)
+static fs::file ppu_decrypt_lle(const std::string& path)
+{
+	fs::stat_t info;
+
+	if (!fs::stat(path, info))
+	{
+		return fs::file{};
+	}
+
+	const std::string cache_path = fs::get_data_dir("", path) + fmt::format("decrypted-%llx-%llx.elf", info.size, info.mtime);
+
+	if (fs::file cached{cache_path})
+	{
+		return cached;
+	}
+
+	fs::file elf = decrypt_self(fs::file(path));
+
+	if (elf)
+	{
+		// Write to a temporary file first to avoid leaving incomplete data
+		const std::string tmp_path = cache_path + ".tmp";
+		elf.seek(0);
+
+		if (!fs::write_file(tmp_path, fs::rewrite, elf.to_vector<u8>()) || !fs::rename(tmp_path, cache_path, true))
+		{
+			LOG_ERROR(LOADER, "Failed to cache decrypted module %s (%s)", path, fs::g_tls_error);
+		}
+	}
+
+	return elf;
+}
+
 void ppu_load_exec(const ppu_exec_object& elf)
 {
 	// Set for delayed initialization in ppu_initialize()
@@ -1357,9 +1396,36 @@ void ppu_load_exec(const ppu_exec_object& elf)
 				"\nVisit https://rpcs3.net/ for Quickstart Guide and more information.");
 		}
 
-		for (const auto& name : load_libs)
+		// Decrypt all libraries in parallel (loading must be sequential)
+		const std::vector<std::string> lib_names(load_libs.begin(), load_libs.end());
+
+		std::vector<fs::file> lib_files(lib_names.size());
+
+		std::vector<std::thread> workers;
+
+		atomic_t<u32> lib_index{0};
+
+		for (u32 i = 0, count = std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 1), ::size32(lib_names)); i < count; i++)
+		{
+			workers.emplace_back([&]()
+			{
+				for (u32 index; (index = lib_index++) < lib_names.size();)
+				{
+					lib_files[index] = ppu_decrypt_lle(lle_dir + lib_names[index]);
+				}
+			});
+		}
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		for (std::size_t i = 0; i < lib_names.size(); i++)
 		{
-			const ppu_prx_object obj = decrypt_self(fs::file(lle_dir + name));
+			const std::string& name = lib_names[i];
+
+			const ppu_prx_object obj = lib_files[i];
 
 			if (obj == elf_error::ok)
 			{
@@ -1390,11 +1456,14 @@ void ppu_load_exec(const ppu_exec_object& elf)
 	_main->name = "";
 	_main->path = vfs::get(Emu.argv[0]);
 
-	// Analyse executable (TODO)
-	_main->analyse(0, static_cast<u32>(elf.header.e_entry));
+	// Analyse executable (or restore analysis results from the cache index)
+	if (!fxm::get_always<ppu_cache_index>()->load(*_main))
+	{
+		_main->analyse(0, static_cast<u32>(elf.header.e_entry));
 
-	// Validate analyser results (not required)
-	_main->validate(0);
+		// Validate analyser results (not required)
+		_main->validate(0);
+	}
 
 	// Set SDK version
 	g_ps3_sdk_version = sdk_version;
@@ -51,7 +51,9 @@
 #endif
 
 #include <thread>
+#include <condition_variable>
 #include <cfenv>
+#include <algorithm>
 #include "Utilities/GSL.h"
 
 const bool s_use_rtm = utils::has_rtm();
@@ -103,10 +105,14 @@ void fmt_class_string<ppu_decoder_type>::format(std::string& out, u64 arg)
 
 const ppu_decoder<ppu_interpreter_precise> s_ppu_interpreter_precise;
 const ppu_decoder<ppu_interpreter_fast> s_ppu_interpreter_fast;
+const ppu_decoder<ppu_itype> s_ppu_itype;
 
 extern void ppu_initialize();
 extern void ppu_initialize(const ppu_module& info);
-static void ppu_initialize2(class jit_compiler& jit, const ppu_module& module_part, const std::string& cache_path, const std::string& obj_name);
+static void ppu_initialize2(class jit_compiler& jit, const ppu_module& module_part, const std::string& cache_path, const std::string& obj_name, bool counters);
+#ifdef LLVM_AVAILABLE
+static std::unique_ptr<class jit_compiler> ppu_recompile_hot(const std::unordered_map<std::string, u64>& link_table, const ppu_module& module_part);
+#endif
 extern void ppu_execute_syscall(ppu_thread& ppu, u64 code);
 
 // Get pointer to executable cache
@@ -131,7 +137,23 @@ static bool ppu_fallback(ppu_thread& ppu, ppu_opcode_t op)
 {
 	if (g_cfg.core.ppu_decoder == ppu_decoder_type::llvm)
 	{
-		fmt::throw_exception("Unregistered PPU function");
+		// No compiled entry point (block entered from outside of the analysed code): run it in the interpreter until a branch
+		while (true)
+		{
+			if (UNLIKELY(test(ppu.state)) && ppu.check_state())
+			{
+				return false;
+			}
+
+			const ppu_opcode_t _op{vm::read32(ppu.cia)};
+
+			if (!s_ppu_interpreter_precise.decode(_op.opcode)(ppu, _op))
+			{
+				return false;
+			}
+
+			ppu.cia += 4;
+		}
 	}
 
 	ppu_ref(ppu.cia) = ppu_cache(ppu.cia);
@@ -170,6 +192,151 @@ static bool ppu_check_toc(ppu_thread& ppu, ppu_opcode_t op)
 	return false;
 }
 
+// Pre-decoded PPU instruction
+struct ppu_sb_op
+{
+	decltype(&ppu_interpreter::UNK) func;
+	ppu_opcode_t op;
+};
+
+// PPU interpreter superblock (straight-line run of pre-decoded instructions)
+struct ppu_superblock
+{
+	const u32 addr;
+
+	// Cleared on invalidation (memory is kept until the cache is destroyed)
+	atomic_t<bool> valid{true};
+
+	// Last successor (must be validated before use)
+	atomic_t<ppu_superblock*> next{};
+
+	std::vector<ppu_sb_op> ops;
+
+	ppu_superblock(u32 addr)
+		: addr(addr)
+	{
+	}
+};
+
+// PPU interpreter superblock cache (global)
+class ppu_superblock_cache
+{
+	shared_mutex m_mutex;
+
+	// Superblocks (start address -> data)
+	std::map<u32, std::unique_ptr<ppu_superblock>> m_map;
+
+	// Invalidated superblocks (may still be executed by other threads)
+	std::vector<std::unique_ptr<ppu_superblock>> m_retired;
+
+public:
+	// Max instruction count
+	static constexpr u32 max_size = 64;
+
+	// Get or build superblock starting at the address
+	ppu_superblock* get(u32 addr)
+	{
+		{
+			reader_lock lock(m_mutex);
+
+			const auto found = m_map.find(addr);
+
+			if (found != m_map.end())
+			{
+				return found->second.get();
+			}
+		}
+
+		writer_lock lock(m_mutex);
+
+		auto& sb = m_map[addr];
+
+		if (sb)
+		{
+			return sb.get();
+		}
+
+		sb = std::make_unique<ppu_superblock>(addr);
+
+		const u32 fallback = ::narrow<u32>(reinterpret_cast<std::uintptr_t>(&ppu_fallback));
+
+		for (u32 pos = addr; sb->ops.size() < max_size; pos += 4)
+		{
+			const ppu_opcode_t op{vm::read32(pos)};
+			const u32 ref = ppu_ref(pos);
+			const u32 func = ppu_cache(pos);
+
+			if (ref != func && ref != fallback)
+			{
+				// Special entry (breakpoint, TOC check) is executed separately
+				if (sb->ops.empty())
+				{
+					sb->ops.push_back({reinterpret_cast<decltype(&ppu_interpreter::UNK)>(std::uintptr_t{ref}), op});
+				}
+
+				break;
+			}
+
+			sb->ops.push_back({reinterpret_cast<decltype(&ppu_interpreter::UNK)>(std::uintptr_t{func}), op});
+
+			// Stop after instructions which may change the control flow
+			switch (s_ppu_itype.decode(op.opcode))
+			{
+			case ppu_itype::UNK:
+			case ppu_itype::B:
+			case ppu_itype::BC:
+			case ppu_itype::BCLR:
+			case ppu_itype::BCCTR:
+			case ppu_itype::SC:
+			case ppu_itype::TD:
+			case ppu_itype::TDI:
+			case ppu_itype::TW:
+			case ppu_itype::TWI:
+			{
+				return sb.get();
+			}
+			default: break;
+			}
+
+			// Don't cross the page boundary
+			if ((pos + 4) % 4096 == 0)
+			{
+				break;
+			}
+		}
+
+		return sb.get();
+	}
+
+	// Invalidate superblocks overlapping with the range
+	void invalidate(u32 addr, u32 size)
+	{
+		writer_lock lock(m_mutex);
+
+		for (auto it = m_map.lower_bound(addr >= max_size * 4 ? addr - max_size * 4 : 0); it != m_map.end() && it->first < u64{addr} + size;)
+		{
+			if (it->first + it->second->ops.size() * 4 > addr)
+			{
+				it->second->valid = false;
+				m_retired.emplace_back(std::move(it->second));
+				it = m_map.erase(it);
+				continue;
+			}
+
+			it++;
+		}
+	}
+};
+
+// Invalidate pre-decoded instructions
+static void ppu_invalidate(u32 addr, u32 size)
+{
+	if (const auto sbc = fxm::get<ppu_superblock_cache>())
+	{
+		sbc->invalidate(addr, size);
+	}
+}
+
 extern void ppu_register_range(u32 addr, u32 size)
 {
 	if (!size)
@@ -178,6 +345,8 @@ extern void ppu_register_range(u32 addr, u32 size)
 		return;
 	}
 
+	ppu_invalidate(addr, size);
+
 	// Register executable range at
 	utils::memory_commit(&ppu_ref(addr), size, utils::protection::rw);
 
@@ -273,6 +442,8 @@ extern void ppu_breakpoint(u32 addr)
 		// Set breakpoint
 		ppu_ref(addr) = _break;
 	}
+
+	ppu_invalidate(addr, 4);
 }
 
 void ppu_thread::on_init(const std::shared_ptr<void>& _this)
@@ -310,6 +481,7 @@ extern void ppu_set_breakpoint(u32 addr)
 	if (ppu_ref(addr) != _break)
 	{
 		ppu_ref(addr) = _break;
+		ppu_invalidate(addr, 4);
 	}
 }
 
@@ -326,6 +498,7 @@ extern void ppu_remove_breakpoint(u32 addr)
 	if (ppu_ref(addr) == _break)
 	{
 		ppu_ref(addr) = ppu_cache(addr);
+		ppu_invalidate(addr, 4);
 	}
 }
 
@@ -355,6 +528,8 @@ extern bool ppu_patch(u32 addr, u32 value)
 			ppu_ref(addr) = ppu_cache(addr);
 		}
 
+		ppu_invalidate(addr, 4);
+
 		if (!vm::check_addr(addr, sizeof(u32), vm::page_writable))
 		{
 			utils::memory_protect(vm::g_base_addr + addr, sizeof(u32), utils::protection::ro);
@@ -531,6 +706,54 @@ void ppu_thread::exec_task()
 
 	v128 _op;
 	using func_t = decltype(&ppu_interpreter::UNK);
+
+	if (g_cfg.core.ppu_superblocks)
+	{
+		const auto sbc = fxm::get_always<ppu_superblock_cache>();
+
+		// Last executed superblock
+		ppu_superblock* sb = nullptr;
+
+		while (true)
+		{
+			if (UNLIKELY(test(state)))
+			{
+				if (check_state()) return;
+
+				// Decode single instruction (may be step)
+				const u32 op = *reinterpret_cast<const be_t<u32>*>(base + cia);
+				if (reinterpret_cast<func_t>((std::uintptr_t)ppu_ref(cia))(*this, {op})) { cia += 4; }
+				sb = nullptr;
+				continue;
+			}
+
+			// Try the last successor first
+			ppu_superblock* next = sb ? sb->next.load() : nullptr;
+
+			if (UNLIKELY(!next || next->addr != cia || !next->valid))
+			{
+				next = sbc->get(cia);
+
+				if (sb)
+				{
+					sb->next = next;
+				}
+			}
+
+			sb = next;
+
+			// Execute pre-decoded instructions
+			for (auto it = sb->ops.data(), end = it + sb->ops.size(); LIKELY(it->func(*this, it->op));)
+			{
+				cia += 4;
+
+				if (++it == end)
+				{
+					break;
+				}
+			}
+		}
+	}
 	func_t func0, func1, func2, func3, func4, func5;
 
 	while (true)
@@ -800,8 +1023,6 @@ void ppu_thread::stack_pop_verbose(u32 addr, u32 size) noexcept
 	LOG_ERROR(PPU, "Invalid thread" HERE);
 }
 
-const ppu_decoder<ppu_itype> s_ppu_itype;
-
 extern u64 get_timebased_time();
 extern ppu_function_t ppu_get_syscall(u64 code);
 
@@ -840,7 +1061,7 @@ static void ppu_trace(u64 addr)
 
 extern u32 ppu_lwarx(ppu_thread& ppu, u32 addr)
 {
-	ppu.rtime = vm::reservation_acquire(addr, sizeof(u32));
+	ppu.rtime = vm::reservation_wait(addr, sizeof(u32));
 	_mm_lfence();
 	ppu.raddr = addr;
 	ppu.rdata = vm::_ref<const atomic_be_t<u32>>(addr);
@@ -849,7 +1070,7 @@ extern u32 ppu_lwarx(ppu_thread& ppu, u32 addr)
 
 extern u64 ppu_ldarx(ppu_thread& ppu, u32 addr)
 {
-	ppu.rtime = vm::reservation_acquire(addr, sizeof(u64));
+	ppu.rtime = vm::reservation_wait(addr, sizeof(u64));
 	_mm_lfence();
 	ppu.raddr = addr;
 	ppu.rdata = vm::_ref<const atomic_be_t<u64>>(addr);
@@ -878,23 +1099,37 @@ extern bool ppu_stwcx(ppu_thread& ppu, u32 addr, u32 reg_value)
 		if (result)
 		{
 			vm::reservation_update(addr, sizeof(u32));
-			vm::notify(addr, sizeof(u32));
 		}
 
 		_xend();
+
+		if (result)
+		{
+			vm::notify(addr, sizeof(u32));
+		}
+
 		ppu.raddr = 0;
 		return result;
 	}
 
-	vm::writer_lock lock(0);
+	// Lock only the lock line (the timestamp must be unchanged since lwarx/ldarx)
+	if (!vm::reservation_trylock(addr, ppu.rtime))
+	{
+		ppu.raddr = 0;
+		return false;
+	}
 
-	const bool result = ppu.rtime == vm::reservation_acquire(addr, sizeof(u32)) && data.compare_and_swap_test(static_cast<u32>(ppu.rdata), reg_value);
+	const bool result = data.compare_and_swap_test(static_cast<u32>(ppu.rdata), reg_value);
 	
 	if (result)
 	{
 		vm::reservation_update(addr, sizeof(u32));
 		vm::notify(addr, sizeof(u32));
 	}
+	else
+	{
+		vm::reservation_unlock(addr, ppu.rtime);
+	}
 
 	ppu.raddr = 0;
 	return result;
@@ -922,23 +1157,37 @@ extern bool ppu_stdcx(ppu_thread& ppu, u32 addr, u64 reg_value)
 		if (result)
 		{
 			vm::reservation_update(addr, sizeof(u64));
-			vm::notify(addr, sizeof(u64));
 		}
 
 		_xend();
+
+		if (result)
+		{
+			vm::notify(addr, sizeof(u64));
+		}
+
 		ppu.raddr = 0;
 		return result;
 	}
 
-	vm::writer_lock lock(0);
+	// Lock only the lock line (the timestamp must be unchanged since lwarx/ldarx)
+	if (!vm::reservation_trylock(addr, ppu.rtime))
+	{
+		ppu.raddr = 0;
+		return false;
+	}
 
-	const bool result = ppu.rtime == vm::reservation_acquire(addr, sizeof(u64)) && data.compare_and_swap_test(ppu.rdata, reg_value);
+	const bool result = data.compare_and_swap_test(ppu.rdata, reg_value);
 
 	if (result)
 	{
 		vm::reservation_update(addr, sizeof(u64));
 		vm::notify(addr, sizeof(u64));
 	}
+	else
+	{
+		vm::reservation_unlock(addr, ppu.rtime);
+	}
 
 	ppu.raddr = 0;
 	return result;
@@ -955,6 +1204,111 @@ static bool adde_carry(u64 a, u64 b, bool c)
 #endif
 }
 
+#ifdef LLVM_AVAILABLE
+// PPU hot function recompiler (global): recompiles frequently executed functions with full optimizations
+class ppu_hot_compiler final
+{
+	struct hot_part
+	{
+		ppu_module info; // Module part (functions in the same order as the counters)
+		std::shared_ptr<u32> counters; // Function entry counters
+		std::vector<bool> done; // Recompiled (or being recompiled) functions
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	std::vector<hot_part> m_parts;
+
+	const std::unordered_map<std::string, u64>* m_link = nullptr;
+
+	// Hot code instances (installed entry points point into them, must stay alive)
+	std::vector<std::unique_ptr<jit_compiler>> m_jits;
+
+	std::shared_ptr<thread_ctrl> m_thread;
+
+	bool m_stop = false;
+
+	// Worker thread entry point
+	void run()
+	{
+		// Set low priority
+		thread_ctrl::set_native_priority(-1);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		while (!m_stop)
+		{
+			m_cv.wait_for(lock, std::chrono::milliseconds(500));
+
+			const u32 threshold = g_cfg.core.ppu_hot_threshold;
+
+			for (std::size_t i = 0; i < m_parts.size() && !m_stop && !Emu.IsStopped(); i++)
+			{
+				auto& part = m_parts[i];
+
+				// Collect hot functions
+				ppu_module hot;
+				hot.copy_part(part.info);
+
+				for (std::size_t fi = 0; fi < part.info.funcs.size(); fi++)
+				{
+					if (!part.done[fi] && part.info.funcs[fi].size && part.counters.get()[fi] >= threshold)
+					{
+						hot.funcs.emplace_back(part.info.funcs[fi]);
+						part.done[fi] = true;
+					}
+				}
+
+				if (hot.funcs.empty())
+				{
+					continue;
+				}
+
+				lock.unlock();
+				auto jit = ppu_recompile_hot(*m_link, hot);
+				lock.lock();
+
+				if (jit)
+				{
+					m_jits.emplace_back(std::move(jit));
+				}
+			}
+		}
+	}
+
+public:
+	~ppu_hot_compiler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+			m_cv.notify_all();
+		}
+
+		if (m_thread)
+		{
+			m_thread->join();
+		}
+	}
+
+	// Start watching entry counters of the module part
+	void add(const std::unordered_map<std::string, u64>& link_table, ppu_module&& part, std::shared_ptr<u32> counters)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto size = part.funcs.size();
+		m_parts.emplace_back(hot_part{std::move(part), std::move(counters), std::vector<bool>(size)});
+		m_link = &link_table;
+
+		if (!m_thread)
+		{
+			thread_ctrl::spawn(m_thread, "PPU Hot Compiler", [this]() { run(); });
+		}
+	}
+};
+#endif
+
 extern void ppu_initialize()
 {
 	const auto _main = fxm::withdraw<ppu_module>();
@@ -1002,6 +1356,7 @@ extern void ppu_initialize(const ppu_module& info)
 			}
 		}
 
+		fxm::get_always<ppu_cache_index>()->save(info, {});
 		return;
 	}
 
@@ -1074,6 +1429,7 @@ extern void ppu_initialize(const ppu_module& info)
 	{
 		std::vector<u64*> vars;
 		std::vector<ppu_function_t> funcs;
+		std::vector<std::shared_ptr<u32>> counters;
 	};
 	
 	// Permanently loaded compiled PPU modules (name -> data)
@@ -1100,28 +1456,47 @@ extern void ppu_initialize(const ppu_module& info)
 	// Global variables to initialize
 	std::vector<std::pair<std::string, u64>> globals;
 
+	// Inject function entry counters for the hot function recompiler
+	const bool hot = g_cfg.core.ppu_hot_threshold != 0;
+
+	// Module parts with entry counters (registered after installation)
+	std::vector<std::pair<ppu_module, std::shared_ptr<u32>>> hot_parts;
+
 	// Split module into fragments <= 1 MiB
 	std::size_t fpos = 0;
 
 	// Difference between function name and current location
 	const u32 reloc = info.name.empty() ? 0 : info.segs.at(0).addr;
 
-	while (jit_mod.vars.empty() && fpos < info.funcs.size())
+	// Initialize global variables of the module part
+	auto add_globals = [&](u32 suffix)
 	{
-		// Initialize compiler instance
-		if (!jit) jit = std::make_unique<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
+		globals.emplace_back(fmt::format("__mptr%x", suffix), (u64)vm::g_base_addr);
+		globals.emplace_back(fmt::format("__cptr%x", suffix), (u64)vm::g_exec_addr);
 
-		// First function in current module part
-		const auto fstart = fpos;
+		// Initialize segments for relocations
+		for (u32 i = 0; i < info.segs.size(); i++)
+		{
+			globals.emplace_back(fmt::format("__seg%u_%x", i, suffix), info.segs[i].addr);
+		}
+	};
 
+	// Allocate entry counters of the module part
+	auto add_counters = [&](u32 suffix, ppu_module&& part)
+	{
+		std::shared_ptr<u32> counters(new u32[part.funcs.size()]{}, std::default_delete<u32[]>());
+		globals.emplace_back(fmt::format("__hot%x", suffix), (u64)counters.get());
+		jit_mod.counters.emplace_back(counters);
+		hot_parts.emplace_back(std::move(part), std::move(counters));
+	};
+
+	// Build next module part starting from fpos
+	auto make_part = [&](ppu_module& part)
+	{
 		// Copy module information (TODO: optimize)
-		ppu_module part;
 		part.copy_part(info);
 		part.funcs.reserve(16000);
 
-		// Unique suffix for each module part
-		const u32 suffix = info.funcs.at(fstart).addr - reloc;
-
 		// Overall block size in bytes
 		std::size_t bsize = 0;
 
@@ -1134,24 +1509,113 @@ extern void ppu_initialize(const ppu_module& info)
 				break;
 			}
 
-			for (auto&& block : func.blocks)
+			if (func.size)
 			{
-				bsize += block.second;
+				for (auto&& block : func.blocks)
+				{
+					bsize += block.second;
+				}
 
-				// Also split functions blocks into functions (TODO)
+				// Copy function info (translated as a whole, with entry points where necessary)
 				ppu_function entry;
-				entry.addr = block.first;
-				entry.size = block.second;
+				entry.addr = func.addr;
+				entry.size = func.size;
 				entry.toc  = func.toc;
-				fmt::append(entry.name, "__0x%x", block.first - reloc);
+				entry.attr = func.attr;
+				entry.blocks = func.blocks;
+				fmt::append(entry.name, "__0x%x", func.addr - reloc);
 				part.funcs.emplace_back(std::move(entry));
 			}
 
 			fpos++;
 		}
+	};
+
+	// Object file version (h: with entry counters)
+	const std::string obj_ver = hot ? "v3h" : "v3";
+
+	const auto index = fxm::get_always<ppu_cache_index>();
+
+	// Module parts (object files)
+	std::vector<ppu_cache_index::part_info> parts;
+
+	if (jit_mod.vars.empty())
+	{
+		// Try to use module parts from the cache index (skips splitting and hashing)
+		parts = index->get_parts(info);
+
+		if (!parts.empty())
+		{
+			jit = std::make_unique<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
+		}
+
+		for (const auto& part : parts)
+		{
+			const std::string cpu_suffix = "-" + jit->cpu() + ".obj";
+
+			if (part.obj_name.size() < cpu_suffix.size() || part.obj_name.compare(part.obj_name.size() - cpu_suffix.size(), cpu_suffix.size(), cpu_suffix) != 0 || !fs::is_file(cache_path + part.obj_name))
+			{
+				parts.clear();
+				break;
+			}
+
+			// Check object version (cached objects may have been compiled with other settings)
+			if (part.obj_name.compare(0, obj_ver.size(), obj_ver) != 0 || (part.obj_name[obj_ver.size()] != '-' && part.obj_name[obj_ver.size()] != '+'))
+			{
+				parts.clear();
+				break;
+			}
+		}
+
+		// Rebuild module parts for the hot function recompiler (must match the objects)
+		std::vector<ppu_module> hot_list;
+
+		for (std::size_t i = 0; hot && i < parts.size(); i++)
+		{
+			if (fpos >= info.funcs.size() || info.funcs[fpos].addr - reloc != parts[i].suffix)
+			{
+				LOG_ERROR(PPU, "LLVM: Cache index mismatch (%s)", parts[i].obj_name);
+				parts.clear();
+				hot_list.clear();
+				break;
+			}
+
+			hot_list.emplace_back();
+			make_part(hot_list.back());
+		}
+
+		for (std::size_t i = 0; i < parts.size(); i++)
+		{
+			add_globals(parts[i].suffix);
+
+			if (hot)
+			{
+				add_counters(parts[i].suffix, std::move(hot_list[i]));
+			}
+
+			jit->add(cache_path + parts[i].obj_name);
+			LOG_SUCCESS(PPU, "LLVM: Loaded module %s", parts[i].obj_name);
+		}
+
+		fpos = parts.empty() ? 0 : info.funcs.size();
+	}
+
+	while (jit_mod.vars.empty() && fpos < info.funcs.size())
+	{
+		// Initialize compiler instance
+		if (!jit) jit = std::make_unique<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
+
+		// First function in current module part
+		const auto fstart = fpos;
+
+		// Unique suffix for each module part
+		const u32 suffix = info.funcs.at(fstart).addr - reloc;
+
+		ppu_module part;
+		make_part(part);
 
 		// Version, module name and hash: vX-liblv2.sprx-0123456789ABCDEF.obj
-		std::string obj_name = "v2";
+		std::string obj_name = obj_ver;
 
 		if (info.name.size())
 		{
@@ -1216,13 +1680,12 @@ extern void ppu_initialize(const ppu_module& info)
 			break;
 		}
 
-		globals.emplace_back(fmt::format("__mptr%x", suffix), (u64)vm::g_base_addr);
-		globals.emplace_back(fmt::format("__cptr%x", suffix), (u64)vm::g_exec_addr);
+		add_globals(suffix);
+		parts.push_back({suffix, obj_name});
 
-		// Initialize segments for relocations
-		for (u32 i = 0; i < info.segs.size(); i++)
+		if (hot)
 		{
-			globals.emplace_back(fmt::format("__seg%u_%x", i, suffix), info.segs[i].addr);
+			add_counters(suffix, ppu_module(part));
 		}
 
 		// Check object file
@@ -1235,7 +1698,7 @@ extern void ppu_initialize(const ppu_module& info)
 		}
 
 		// Create worker thread for compilation
-		jthreads.emplace_back([&jit, &jmutex, &jcores, obj_name = obj_name, part = std::move(part), &cache_path]()
+		jthreads.emplace_back([&jit, &jmutex, &jcores, obj_name = obj_name, part = std::move(part), &cache_path, hot]()
 		{
 			// Set low priority
 			thread_ctrl::set_native_priority(-1);
@@ -1251,7 +1714,7 @@ extern void ppu_initialize(const ppu_module& info)
 
 				// Use another JIT instance
 				jit_compiler jit2({}, g_cfg.core.llvm_cpu);
-				ppu_initialize2(jit2, part, cache_path, obj_name);
+				ppu_initialize2(jit2, part, cache_path, obj_name, hot);
 			}
 
 			if (Emu.IsStopped() || !fs::is_file(cache_path + obj_name))
@@ -1280,6 +1743,13 @@ extern void ppu_initialize(const ppu_module& info)
 	if (jit && jit_mod.vars.empty())
 	{	
 		jit->fin();
+
+		// Update the cache index if all module parts have been compiled
+		if (std::all_of(parts.begin(), parts.end(), [&](const ppu_cache_index::part_info& part) { return fs::is_file(cache_path + part.obj_name); }))
+		{
+			index->save(info, parts);
+		}
+
 		// Get and install function addresses
 		for (const auto& func : info.funcs)
 		{
@@ -1289,9 +1759,14 @@ extern void ppu_initialize(const ppu_module& info)
 			{
 				if (block.second)
 				{
+					// Only the blocks which can be entered from outside have entry points
 					const u64 addr = jit->get(fmt::format("__0x%x", block.first - reloc));
 					jit_mod.funcs.emplace_back(reinterpret_cast<ppu_function_t>(addr));
-					ppu_ref(block.first) = ::narrow<u32>(addr);
+
+					if (addr)
+					{
+						ppu_ref(block.first) = ::narrow<u32>(addr);
+					}
 				}
 			}
 		}
@@ -1308,6 +1783,12 @@ extern void ppu_initialize(const ppu_module& info)
 				*reinterpret_cast<u64*>(addr) = var.second;
 			}
 		}
+
+		// Start watching entry counters
+		for (auto& part : hot_parts)
+		{
+			fxm::get_always<ppu_hot_compiler>()->add(s_link_table, std::move(part.first), std::move(part.second));
+		}
 	}
 	else
 	{
@@ -1322,7 +1803,10 @@ extern void ppu_initialize(const ppu_module& info)
 			{
 				if (block.second)
 				{
-					ppu_ref(block.first) = ::narrow<u32>(reinterpret_cast<uptr>(jit_mod.funcs[index++]));
+					if (const auto ptr = jit_mod.funcs[index++])
+					{
+						ppu_ref(block.first) = ::narrow<u32>(reinterpret_cast<uptr>(ptr));
+					}
 				}
 			}
 		}
@@ -1330,7 +1814,7 @@ extern void ppu_initialize(const ppu_module& info)
 		index = 0;
 
 		// Rewrite global variables
-		while (index < jit_mod.vars.size())
+		for (std::size_t part = 0; index < jit_mod.vars.size(); part++)
 		{
 			*jit_mod.vars[index++] = (u64)vm::g_base_addr;
 			*jit_mod.vars[index++] = (u64)vm::g_exec_addr;
@@ -1339,6 +1823,11 @@ extern void ppu_initialize(const ppu_module& info)
 			{
 				*jit_mod.vars[index++] = seg.addr;
 			}
+
+			if (!jit_mod.counters.empty())
+			{
+				*jit_mod.vars[index++] = (u64)jit_mod.counters[part].get();
+			}
 		}
 	}
 #else
@@ -1346,7 +1835,7 @@ extern void ppu_initialize(const ppu_module& info)
 #endif
 }
 
-static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, const std::string& cache_path, const std::string& obj_name)
+static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, const std::string& cache_path, const std::string& obj_name, bool counters)
 {
 #ifdef LLVM_AVAILABLE
 	using namespace llvm;
@@ -1358,21 +1847,7 @@ static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, co
 	module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
 	
 	// Initialize translator
-	PPUTranslator translator(jit.get_context(), module.get(), module_part);
-
-	// Define some types
-	const auto _void = Type::getVoidTy(jit.get_context());
-	const auto _func = FunctionType::get(_void, {translator.GetContextType()->getPointerTo()}, false);
-
-	// Initialize function list
-	for (const auto& func : module_part.funcs)
-	{
-		if (func.size)
-		{
-			const auto f = cast<Function>(module->getOrInsertFunction(func.name, _func));
-			f->addAttribute(1, Attribute::NoAlias);
-		}
-	}
+	PPUTranslator translator(jit.get_context(), module.get(), module_part, counters);
 
 	std::shared_ptr<MsgDialogBase> dlg;
 
@@ -1492,3 +1967,108 @@ static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, co
 	jit.add(std::move(module), cache_path);
 #endif // LLVM_AVAILABLE
 }
+
+#ifdef LLVM_AVAILABLE
+static std::unique_ptr<jit_compiler> ppu_recompile_hot(const std::unordered_map<std::string, u64>& link_table, const ppu_module& module_part)
+{
+	using namespace llvm;
+
+	// Primary JIT instance (functions are installed directly, returned to the caller to keep it alive)
+	auto jit_ptr = std::make_unique<jit_compiler>(link_table, g_cfg.core.llvm_cpu);
+	jit_compiler& jit = *jit_ptr;
+
+	// Suffix of global variables (see PPUTranslator)
+	const u32 gsuffix = module_part.name.empty() ? module_part.funcs[0].addr : module_part.funcs[0].addr - module_part.segs[0].addr;
+
+	// Create LLVM module
+	std::unique_ptr<Module> module = std::make_unique<Module>(fmt::format("__hot%x", gsuffix), jit.get_context());
+
+	// Initialize target
+	module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
+
+	// Initialize translator (without entry counters)
+	PPUTranslator translator(jit.get_context(), module.get(), module_part);
+
+	{
+		legacy::FunctionPassManager pm(module.get());
+
+		// Full optimizations
+		pm.add(createCFGSimplificationPass());
+		pm.add(createPromoteMemoryToRegisterPass());
+		pm.add(createEarlyCSEPass());
+		pm.add(createInstructionCombiningPass());
+		pm.add(createLICMPass());
+		pm.add(createNewGVNPass());
+		pm.add(createDeadStoreEliminationPass());
+		pm.add(createInstructionCombiningPass());
+		pm.add(createAggressiveDCEPass());
+		pm.add(createCFGSimplificationPass());
+
+		// Translate functions
+		for (const auto& func : module_part.funcs)
+		{
+			if (Emu.IsStopped())
+			{
+				return nullptr;
+			}
+
+			if (const auto f = translator.Translate(func))
+			{
+				pm.run(*f);
+			}
+			else
+			{
+				LOG_ERROR(PPU, "LLVM: Failed to recompile hot function %s", func.name);
+				return nullptr;
+			}
+		}
+
+		std::string result;
+		raw_string_ostream out(result);
+
+		if (verifyModule(*module, &out))
+		{
+			out.flush();
+			LOG_ERROR(PPU, "LLVM: Verification failed for hot functions (0x%x):\n%s", gsuffix, result);
+			return nullptr;
+		}
+	}
+
+	jit.add(std::move(module), {});
+	jit.fin();
+
+	// Initialize global variables
+	const auto set_var = [&](const std::string& name, u64 value)
+	{
+		if (const u64 addr = jit.get(name))
+		{
+			*reinterpret_cast<u64*>(addr) = value;
+		}
+	};
+
+	set_var(fmt::format("__mptr%x", gsuffix), (u64)vm::g_base_addr);
+	set_var(fmt::format("__cptr%x", gsuffix), (u64)vm::g_exec_addr);
+
+	for (u32 i = 0; i < module_part.segs.size(); i++)
+	{
+		set_var(fmt::format("__seg%u_%x", i, gsuffix), module_part.segs[i].addr);
+	}
+
+	// Replace entry points (old code remains valid for threads still executing it)
+	const u32 reloc = module_part.name.empty() ? 0 : module_part.segs[0].addr;
+
+	for (const auto& func : module_part.funcs)
+	{
+		for (const auto& block : func.blocks)
+		{
+			if (const u64 addr = block.second ? jit.get(fmt::format("__0x%x", block.first - reloc)) : 0)
+			{
+				ppu_ref(block.first) = ::narrow<u32>(addr);
+			}
+		}
+	}
+
+	LOG_SUCCESS(PPU, "LLVM: Recompiled %zu hot functions", module_part.funcs.size());
+	return jit_ptr;
+}
+#endif // LLVM_AVAILABLE
@@ -133,6 +133,11 @@ public:
 	u64 rdata{0}; // Reservation data
 	
 	atomic_t<u32> prio{0}; // Thread priority (0..3071)
+
+	// lv2 scheduler queue links (protected by the scheduler mutex)
+	ppu_thread* sched_prev{};
+	ppu_thread* sched_next{};
+	u32 sched_prio{~0u}; // Priority bucket (-1 if not queued)
 	const u32 stack_size; // Stack size
 	const u32 stack_addr; // Stack address
 	
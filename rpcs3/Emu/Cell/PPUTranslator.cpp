@@ -10,8 +10,9 @@
 using namespace llvm;
 
 const ppu_decoder<PPUTranslator> s_ppu_decoder;
+const ppu_decoder<ppu_itype> s_ppu_itype;
 
-PPUTranslator::PPUTranslator(LLVMContext& context, Module* module, const ppu_module& info)
+PPUTranslator::PPUTranslator(LLVMContext& context, Module* module, const ppu_module& info, bool counters)
 	: m_context(context)
 	, m_module(module)
 	, m_is_be(false)
@@ -51,6 +52,14 @@ PPUTranslator::PPUTranslator(LLVMContext& context, Module* module, const ppu_mod
 	m_call->setInitializer(ConstantPointerNull::get(cast<PointerType>(m_call->getType()->getPointerElementType())));
 	m_call->setExternallyInitialized(true);
 
+	// Entry counters (one u32 per function of the module part)
+	if (counters)
+	{
+		m_hot = new GlobalVariable(*module, ArrayType::get(GetType<u32>(), m_info.funcs.size())->getPointerTo(), true, GlobalValue::ExternalLinkage, 0, fmt::format("__hot%x", gsuffix));
+		m_hot->setInitializer(ConstantPointerNull::get(cast<PointerType>(m_hot->getType()->getPointerElementType())));
+		m_hot->setExternallyInitialized(true);
+	}
+
 	const auto md_name = MDString::get(m_context, "branch_weights");
 	const auto md_low = ValueAsMetadata::get(ConstantInt::get(GetType<u32>(), 1));
 	const auto md_high = ValueAsMetadata::get(ConstantInt::get(GetType<u32>(), 666));
@@ -108,6 +117,15 @@ PPUTranslator::PPUTranslator(LLVMContext& context, Module* module, const ppu_mod
 	{
 		m_reloc = &m_info.segs[0];
 	}
+
+	// Functions of the module can be called directly
+	for (const auto& func : m_info.funcs)
+	{
+		if (func.size)
+		{
+			m_funcs.emplace(func.addr - (m_reloc ? m_reloc->addr : 0));
+		}
+	}
 }
 
 PPUTranslator::~PPUTranslator()
@@ -119,39 +137,203 @@ Type* PPUTranslator::GetContextType()
 	return m_thread_type;
 }
 
+std::set<u32> PPUTranslator::GetEntries(const ppu_function& info)
+{
+	std::set<u32> result{info.addr};
+
+	// Blocks reached by direct branches or fallthrough within the function
+	std::set<u32> reached;
+
+	for (const auto& block : info.blocks)
+	{
+		if (!block.second)
+		{
+			continue;
+		}
+
+		const u32 end = block.first + block.second;
+
+		// Block may continue at the next address (unless it ends with an unconditional branch)
+		bool next = true;
+
+		for (u32 addr = block.first; addr < end; addr += 4)
+		{
+			const ppu_opcode_t op{vm::ps3::read32(vm::cast(addr))};
+
+			switch (const auto type = s_ppu_itype.decode(op.opcode))
+			{
+			case ppu_itype::B:
+			case ppu_itype::BC:
+			{
+				const u32 target = (op.aa ? 0 : addr) + (type == ppu_itype::B ? +op.bt24 : +op.bt14);
+
+				if (op.lk)
+				{
+					// Return address
+					result.emplace(addr + 4);
+				}
+
+				if (target <= addr)
+				{
+					// Backward branch (checks the state and may be resumed from outside)
+					result.emplace(target);
+				}
+
+				reached.emplace(target);
+				next = op.lk || (type == ppu_itype::BC && (op.bo & 0x14) != 0x14);
+				break;
+			}
+			case ppu_itype::BCLR:
+			case ppu_itype::BCCTR:
+			{
+				if (op.lk)
+				{
+					result.emplace(addr + 4);
+				}
+				else if (type == ppu_itype::BCCTR)
+				{
+					// Jump table (targets are unknown): every block is an entry point
+					for (const auto& jt_block : info.blocks)
+					{
+						result.emplace(jt_block.first);
+					}
+				}
+
+				next = op.lk || (op.bo & 0x14) != 0x14;
+				break;
+			}
+			case ppu_itype::SC:
+			{
+				// Continued after the syscall
+				result.emplace(addr + 4);
+				break;
+			}
+			default:
+			{
+				next = true;
+				break;
+			}
+			}
+		}
+
+		if (next)
+		{
+			reached.emplace(end);
+		}
+	}
+
+	for (const auto& block : info.blocks)
+	{
+		if (block.second && !reached.count(block.first))
+		{
+			// Block is only reachable from outside
+			result.emplace(block.first);
+		}
+	}
+
+	return result;
+}
+
 Function* PPUTranslator::Translate(const ppu_function& info)
 {
-	m_function = m_module->getFunction(info.name);
-	
+	// Instruction address is (m_addr + base)
+	const u64 base = m_reloc ? m_reloc->addr : 0;
+
+	// Function body: all blocks of the function, with the index of the entry point as the second argument
+	const auto stub_type = FunctionType::get(GetType<void>(), {m_thread_type->getPointerTo()}, false);
+	const auto body_type = FunctionType::get(GetType<void>(), {m_thread_type->getPointerTo(), GetType<u32>()}, false);
+	m_function = cast<Function>(m_module->getOrInsertFunction(fmt::format("__f0x%x", info.addr - base), body_type));
+	m_function->setLinkage(GlobalValue::InternalLinkage);
+	m_function->addAttribute(1, Attribute::NoAlias);
+
 	std::fill(std::begin(m_globals), std::end(m_globals), nullptr);
 	std::fill(std::begin(m_locals), std::end(m_locals), nullptr);
 
 	IRBuilder<> irb(m_entry = BasicBlock::Create(m_context, "__entry", m_function));
 	m_ir = &irb;
 
-	// Instruction address is (m_addr + base)
-	const u64 base = m_reloc ? m_reloc->addr : 0;
-	m_addr = info.addr - base;
-
 	m_thread = &*m_function->getArgumentList().begin();
 	m_base_loaded = m_ir->CreateLoad(m_base);
 
-	m_body = BasicBlock::Create(m_context, "__body", m_function);
+	// Increment entry counter (used to find hot functions)
+	if (m_hot && &info >= m_info.funcs.data() && &info < m_info.funcs.data() + m_info.funcs.size())
+	{
+		const auto ptr = m_ir->CreateGEP(m_ir->CreateLoad(m_hot), {m_ir->getInt64(0), m_ir->getInt64(&info - m_info.funcs.data())});
+		m_ir->CreateStore(m_ir->CreateAdd(m_ir->CreateLoad(ptr), m_ir->getInt32(1)), ptr);
+	}
 
-	// Check status register in the entry block
-	const auto vstate = m_ir->CreateLoad(m_ir->CreateStructGEP(nullptr, m_thread, 1), true);
-	const auto vcheck = BasicBlock::Create(m_context, "__test", m_function);
-	m_ir->CreateCondBr(m_ir->CreateIsNull(vstate), m_body, vcheck, m_md_likely);
+	// Create basic blocks
+	m_blocks.clear();
 
-	// Create tail call to the check function
-	m_ir->SetInsertPoint(vcheck);
-	Call(GetType<void>(), "__check", m_thread, GetAddr())->setTailCallKind(llvm::CallInst::TCK_Tail);
-	m_ir->CreateRetVoid();
-	m_ir->SetInsertPoint(m_body);
+	for (const auto& block : info.blocks)
+	{
+		if (block.second)
+		{
+			m_blocks.emplace(block.first - base, BasicBlock::Create(m_context, fmt::format("__0x%x", block.first - base), m_function));
+		}
+	}
+
+	// Jump to the entry point
+	const auto vbad = BasicBlock::Create(m_context, "__bad", m_function);
+	const auto vswitch = m_ir->CreateSwitch(&*std::next(m_function->arg_begin()), vbad);
+	m_ir->SetInsertPoint(vbad);
+	m_ir->CreateUnreachable();
+
+	u32 index = 0;
+
+	for (const u32 entry : GetEntries(info))
+	{
+		const auto found = m_blocks.find(entry - base);
+
+		if (found == m_blocks.end())
+		{
+			continue;
+		}
+
+		// Create entry point function (checks the status register)
+		const auto stub = cast<Function>(m_module->getOrInsertFunction(fmt::format("__0x%x", entry - base), stub_type));
+
+		if (!stub->empty())
+		{
+			// Already defined by another function sharing the block
+			continue;
+		}
+
+		stub->addAttribute(1, Attribute::NoAlias);
+		vswitch->addCase(m_ir->getInt32(index), found->second);
+
+		const auto thread = &*stub->arg_begin();
+		const auto vcall = BasicBlock::Create(m_context, "__call", stub);
+		const auto vcheck = BasicBlock::Create(m_context, "__test", stub);
+		m_ir->SetInsertPoint(BasicBlock::Create(m_context, "__entry", stub, vcall));
+		const auto vstate = m_ir->CreateLoad(m_ir->CreateStructGEP(nullptr, thread, 1), true);
+		m_ir->CreateCondBr(m_ir->CreateIsNull(vstate), vcall, vcheck, m_md_likely);
+
+		m_ir->SetInsertPoint(vcall);
+		m_ir->CreateCall(m_function, {thread, m_ir->getInt32(index++)})->setTailCallKind(llvm::CallInst::TCK_Tail);
+		m_ir->CreateRetVoid();
+
+		// Create tail call to the check function
+		m_ir->SetInsertPoint(vcheck);
+		m_addr = entry - base;
+		Call(GetType<void>(), "__check", thread, GetAddr())->setTailCallKind(llvm::CallInst::TCK_Tail);
+		m_ir->CreateRetVoid();
+	}
 
 	// Process blocks
-	const auto block = std::make_pair(info.addr, info.size);
+	for (const auto& block : info.blocks)
 	{
+		if (!block.second)
+		{
+			continue;
+		}
+
+		m_ir->SetInsertPoint(m_blocks.at(block.first - base));
+
+		// Guest registers are loaded again in each block (all of them are flushed before the branch)
+		std::fill(std::begin(m_globals), std::end(m_globals), nullptr);
+		std::fill(std::begin(m_locals), std::end(m_locals), nullptr);
+
 		// Optimize BLR (prefetch LR)
 		if (vm::ps3::read32(vm::cast(block.first + block.second - 4)) == ppu_instructions::BLR())
 		{
@@ -161,7 +343,7 @@ Function* PPUTranslator::Translate(const ppu_function& info)
 		// Process the instructions
 		for (m_addr = block.first - base; m_addr < block.first + block.second - base; m_addr += 4)
 		{
-			if (m_body->getTerminator())
+			if (m_ir->GetInsertBlock()->getTerminator())
 			{
 				break;
 			}
@@ -190,10 +372,20 @@ Function* PPUTranslator::Translate(const ppu_function& info)
 		}
 
 		// Finalize current block if necessary (create branch to the next address)
-		if (!m_body->getTerminator())
+		if (!m_ir->GetInsertBlock()->getTerminator())
 		{
 			FlushRegisters();
-			CallFunction(m_addr);
+
+			const auto found = m_blocks.find(m_addr);
+
+			if (found != m_blocks.end())
+			{
+				m_ir->CreateBr(found->second);
+			}
+			else
+			{
+				CallFunction(m_addr);
+			}
 		}
 	}
 
@@ -250,6 +442,33 @@ void PPUTranslator::CallFunction(u64 target, Value* indirect)
 			return;
 		}
 
+		const auto found = m_blocks.find(target);
+
+		if (found != m_blocks.end())
+		{
+			if (target <= m_addr)
+			{
+				// Backward branch within the function: check status register
+				const auto vstate = m_ir->CreateLoad(m_ir->CreateStructGEP(nullptr, m_thread, 1), true);
+				const auto vcheck = BasicBlock::Create(m_context, "__test", m_function);
+				m_ir->CreateCondBr(m_ir->CreateIsNull(vstate), found->second, vcheck, m_md_likely);
+				m_ir->SetInsertPoint(vcheck);
+				Call(GetType<void>(), "__check", m_thread, GetAddr(target - m_addr))->setTailCallKind(llvm::CallInst::TCK_Tail);
+				m_ir->CreateRetVoid();
+				return;
+			}
+
+			// Direct branch within the function
+			m_ir->CreateBr(found->second);
+			return;
+		}
+
+		if (!m_funcs.count(target))
+		{
+			// Call the function through the executable cache (it may be located in another module part)
+			return CallFunction(0, GetAddr(target - m_addr));
+		}
+
 		indirect = m_module->getOrInsertFunction(fmt::format("__0x%llx", target), type);
 	}
 	else
@@ -263,9 +482,16 @@ void PPUTranslator::CallFunction(u64 target, Value* indirect)
 			}
 		}
 
+		// Set the current address (the target may have no entry point and run in the interpreter)
+		const auto vcia = m_ir->CreateStructGEP(nullptr, m_thread, ::narrow<uint>(&m_cia - m_locals));
+		const auto vaddr = Trunc(indirect, GetType<u32>());
+
 		const auto pos = m_ir->CreateLShr(indirect, 2, "", true);
 		const auto ptr = m_ir->CreateGEP(m_ir->CreateLoad(m_call), {m_ir->getInt64(0), pos});
 		indirect = m_ir->CreateIntToPtr(m_ir->CreateLoad(ptr), type->getPointerTo());
+
+		m_ir->SetInsertPoint(block);
+		m_ir->CreateStore(vaddr, vcia);
 	}
 
 	m_ir->SetInsertPoint(block);
@@ -155,10 +155,18 @@ class PPUTranslator final //: public CPUTranslator
 	// Callable functions
 	llvm::GlobalVariable* m_call;
 
+	// Function entry counters (optional)
+	llvm::GlobalVariable* m_hot = nullptr;
+
 	// Main block
-	llvm::BasicBlock* m_body;
 	llvm::BasicBlock* m_entry;
 
+	// Basic blocks of the current function (position-independent address -> block)
+	std::map<u64, llvm::BasicBlock*> m_blocks;
+
+	// Functions of the module (position-independent addresses, called directly)
+	std::set<u64> m_funcs;
+
 	// Thread context struct
 	llvm::StructType* m_thread_type;
 
@@ -420,12 +428,15 @@ public:
 	// Handle compilation errors
 	void CompilationError(const std::string& error);
 
-	PPUTranslator(llvm::LLVMContext& context, llvm::Module* module, const ppu_module& info);
+	PPUTranslator(llvm::LLVMContext& context, llvm::Module* module, const ppu_module& info, bool counters = false);
 	~PPUTranslator();
 
 	// Get thread context struct type
 	llvm::Type* GetContextType();
 
+	// Find addresses (absolute) where the function can be entered from outside
+	std::set<u32> GetEntries(const ppu_function& info);
+
 	// Parses PPU opcodes and translate them into LLVM IR
 	llvm::Function* Translate(const ppu_function& info);
 
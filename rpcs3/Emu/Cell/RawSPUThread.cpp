@@ -5,6 +5,7 @@
 #include "Loader/ELF.h"
 
 #include "Emu/Cell/RawSPUThread.h"
+#include "Emu/Cell/SPURecompiler.h"
 
 // Originally, SPU MFC registers are accessed externally in a concurrent manner (don't mix with channels, SPU MFC channels are isolated)
 thread_local spu_mfc_cmd g_tls_mfc[8] = {};
@@ -256,5 +257,11 @@ void spu_load_exec(const spu_exec_object& elf)
 	spu->cpu_init();
 	spu->npc = elf.header.e_entry;
 
+	if (spu_precompiler::enabled())
+	{
+		const auto ls = vm::ps3::_ptr<const be_t<u32>>(spu->offset);
+		fxm::get_always<spu_precompiler>()->add(std::vector<be_t<u32>>(ls, ls + 0x10000), spu->npc);
+	}
+
 	fxm::get_always<mfc_thread>()->add_spu(std::move(spu));
 }
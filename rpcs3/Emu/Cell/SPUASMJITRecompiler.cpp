@@ -39,7 +39,7 @@ void spu_recompiler::compile(spu_function_t& f)
 {
 	std::lock_guard<std::mutex> lock(m_mutex);
 
-	if (f.compiled)
+	if (f.compiled.load())
 	{
 		// return if function already compiled
 		return;
@@ -235,7 +235,7 @@ void spu_recompiler::compile(spu_function_t& f)
 	Func fn;
 	m_jit->add(&fn, codeHolder);
 
-	f.compiled = asmjit::Internal::ptr_cast<decltype(f.compiled)>(fn);
+	f.compiled = asmjit::Internal::ptr_cast<spu_function_t::func_t>(fn);
 	
 	if (g_cfg.core.spu_debug)
 	{
@@ -290,39 +290,8 @@ inline asmjit::X86Mem spu_recompiler::XmmConst(__m128i data)
 
 void spu_recompiler::InterpreterCall(spu_opcode_t op)
 {
-	auto gate = [](SPUThread* _spu, u32 opcode, spu_inter_func_t _func) noexcept -> u32
-	{
-		try
-		{
-			// TODO: check correctness
-
-			const u32 old_pc = _spu->pc;
-
-			if (test(_spu->state) && _spu->check_state())
-			{
-				return 0x2000000 | _spu->pc;
-			}
-
-			_func(*_spu, { opcode });
-
-			if (old_pc != _spu->pc)
-			{
-				_spu->pc += 4;
-				return 0x2000000 | _spu->pc;
-			}
-
-			_spu->pc += 4;
-			return 0;
-		}
-		catch (...)
-		{
-			_spu->pending_exception = std::current_exception();
-			return 0x1000000 | _spu->pc;
-		}
-	};
-
 	c->mov(SPU_OFF_32(pc), m_pos);
-	asmjit::CCFuncCall* call = c->call(asmjit::imm_ptr(asmjit::Internal::ptr_cast<void*, u32(SPUThread*, u32, spu_inter_func_t)>(gate)), asmjit::FuncSignature3<u32, void*, u32, void*>(asmjit::CallConv::kIdHost));
+	asmjit::CCFuncCall* call = c->call(asmjit::imm_ptr(asmjit::Internal::ptr_cast<void*, u32(SPUThread*, u32, spu_inter_func_t)>(&spu_recompiler_base::interpreter_call)), asmjit::FuncSignature3<u32, void*, u32, void*>(asmjit::CallConv::kIdHost));
 	call->setArg(0, *cpu);
 	call->setArg(1, asmjit::imm_u(op.opcode));
 	call->setArg(2, asmjit::imm_ptr(asmjit::Internal::ptr_cast<void*>(s_spu_interpreter.decode(op.opcode))));
@@ -336,69 +305,7 @@ void spu_recompiler::InterpreterCall(spu_opcode_t op)
 
 void spu_recompiler::FunctionCall()
 {
-	auto gate = [](SPUThread* _spu, u32 link) noexcept -> u32
-	{
-		_spu->recursion_level++;
-
-		try
-		{
-			// TODO: check correctness
-
-			if (_spu->pc & 0x4000000)
-			{
-				if (_spu->pc & 0x8000000)
-				{
-					fmt::throw_exception("Undefined behaviour" HERE);
-				}
-
-				_spu->set_interrupt_status(true);
-				_spu->pc &= ~0x4000000;
-			}
-			else if (_spu->pc & 0x8000000)
-			{
-				_spu->set_interrupt_status(false);
-				_spu->pc &= ~0x8000000;
-			}
-
-			if (_spu->pc == link)
-			{
-				LOG_ERROR(SPU, "Branch-to-next");
-			}
-			else if (_spu->pc == link - 4)
-			{
-				LOG_ERROR(SPU, "Branch-to-self");
-			}
-
-			while (!test(_spu->state) || !_spu->check_state())
-			{
-				// Proceed recursively
-				spu_recompiler_base::enter(*_spu);
-
-				if (test(_spu->state & cpu_flag::ret))
-				{
-					break;
-				}
-
-				if (_spu->pc == link)
-				{
-					_spu->recursion_level--;
-					return 0; // Successfully returned 
-				}
-			}
-
-			_spu->recursion_level--;
-			return 0x2000000 | _spu->pc;
-		}
-		catch (...)
-		{
-			_spu->pending_exception = std::current_exception();
-
-			_spu->recursion_level--;
-			return 0x1000000 | _spu->pc;
-		}
-	};
-
-	asmjit::CCFuncCall* call = c->call(asmjit::imm_ptr(asmjit::Internal::ptr_cast<void*, u32(SPUThread*, u32)>(gate)), asmjit::FuncSignature2<u32, SPUThread*, u32>(asmjit::CallConv::kIdHost));
+	asmjit::CCFuncCall* call = c->call(asmjit::imm_ptr(asmjit::Internal::ptr_cast<void*, u32(SPUThread*, u32)>(&spu_recompiler_base::function_call)), asmjit::FuncSignature2<u32, SPUThread*, u32>(asmjit::CallConv::kIdHost));
 	call->setArg(0, *cpu);
 	call->setArg(1, asmjit::imm_u(spu_branch_target(m_pos + 4)));
 	call->setRet(0, *addr);
@@ -409,6 +316,22 @@ void spu_recompiler::FunctionCall()
 	c->unuse(*addr);
 }
 
+void spu_recompiler::CheckStore()
+{
+	// Mark LS page stored to by *addr as modified if it contains compiled code (see SPUThread::ls_store)
+	asmjit::Label skip = c->newLabel();
+	c->mov(qw1->r32(), *addr);
+	c->shr(qw1->r32(), 12);
+	c->mov(*qw0, SPU_OFF_64(ls_code_mask));
+	c->bt(*qw0, *qw1);
+	c->jnc(skip);
+	c->mov(*qw0, 1);
+	c->lock().xadd(SPU_OFF_64(ls_stamp), *qw0);
+	c->inc(*qw0);
+	c->mov(asmjit::x86::qword_ptr(*cpu, *qw1, 3, offset32(&SPUThread::ls_page_stamp)), *qw0);
+	c->bind(skip);
+}
+
 void spu_recompiler::STOP(spu_opcode_t op)
 {
 	InterpreterCall(op); // TODO
@@ -1006,6 +929,7 @@ void spu_recompiler::STQX(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::x86::oword_ptr(*ls, *addr), vt);
+	CheckStore();
 	c->unuse(*addr);
 }
 
@@ -2289,6 +2213,9 @@ void spu_recompiler::STQA(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::x86::oword_ptr(*ls, spu_ls_target(0, op.i16)), vt);
+	c->mov(*addr, spu_ls_target(0, op.i16));
+	CheckStore();
+	c->unuse(*addr);
 }
 
 void spu_recompiler::BRNZ(spu_opcode_t op)
@@ -2371,6 +2298,9 @@ void spu_recompiler::STQR(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::x86::oword_ptr(*ls, spu_ls_target(m_pos, op.i16)), vt);
+	c->mov(*addr, spu_ls_target(m_pos, op.i16));
+	CheckStore();
+	c->unuse(*addr);
 }
 
 void spu_recompiler::BRA(spu_opcode_t op)
@@ -2600,6 +2530,7 @@ void spu_recompiler::STQD(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::x86::oword_ptr(*ls, *addr), vt);
+	CheckStore();
 	c->unuse(*addr);
 }
 
@@ -80,6 +80,7 @@ private:
 public:
 	void InterpreterCall(spu_opcode_t op);
 	void FunctionCall();
+	void CheckStore();
 
 	void STOP(spu_opcode_t op);
 	void LNOP(spu_opcode_t op);
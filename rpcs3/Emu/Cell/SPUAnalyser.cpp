@@ -2,6 +2,7 @@
 #include "SPUAnalyser.h"
 #include "SPURecompiler.h"
 #include "SPUOpcodes.h"
+#include "Emu/System.h"
 
 const spu_decoder<spu_itype> s_spu_itype;
 
@@ -21,16 +22,164 @@ spu_function_t* SPUDatabase::find(const be_t<u32>* data, u64 key, u32 max_size)
 	return nullptr;
 }
 
+// Database file signature: "SPUDB" and version (increment when the format or the analyser changes)
+static const u64 s_spu_db_magic = 0x5350554442000001;
+
+// Database file record header, followed by function contents, block, adjacent and jump table addresses
+struct spu_db_record
+{
+	u32 addr;
+	u32 size;
+	u32 blocks;
+	u32 adjacent;
+	u32 jtable;
+	u32 flags; // 1: does_reset_stack
+};
+
 SPUDatabase::SPUDatabase()
 {
-	// TODO: load existing database associated with currently running executable
+	load();
 
-	LOG_SUCCESS(SPU, "SPU Database initialized...");
+	LOG_SUCCESS(SPU, "SPU Database initialized (%u functions loaded)...", m_db.size());
 }
 
 SPUDatabase::~SPUDatabase()
 {
-	// TODO: serialize database
+}
+
+void SPUDatabase::load()
+{
+	const std::string path = Emu.GetCachePath() + "spu.db";
+
+	if (!m_file.open(path, fs::read + fs::write + fs::create))
+	{
+		LOG_ERROR(SPU, "Failed to open SPU database: %s (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	u64 magic = 0;
+
+	if (!m_file.read(magic) || magic != s_spu_db_magic)
+	{
+		// Create new database (or discard the outdated one)
+		m_file.trunc(0);
+		m_file.seek(0);
+		m_file.write(s_spu_db_magic);
+		return;
+	}
+
+	// Position after the last valid record
+	u64 pos = m_file.pos();
+
+	for (spu_db_record rec; m_file.read(rec); pos = m_file.pos())
+	{
+		if (rec.addr >= 0x40000 || rec.addr % 4 || !rec.size || rec.size % 4 || rec.size > 0x40000 - rec.addr)
+		{
+			break;
+		}
+
+		if (rec.blocks > 0x10000 || rec.adjacent > 0x10000 || rec.jtable > 0x10000)
+		{
+			break;
+		}
+
+		auto func = std::make_shared<spu_function_t>(rec.addr, rec.size);
+		func->data.resize(rec.size / 4);
+		func->does_reset_stack = (rec.flags & 1) != 0;
+
+		std::vector<u32> blocks(rec.blocks), adjacent(rec.adjacent), jtable(rec.jtable);
+
+		if (m_file.read(func->data.data(), rec.size) != rec.size || !m_file.read(blocks) || !m_file.read(adjacent) || !m_file.read(jtable))
+		{
+			break;
+		}
+
+		func->blocks.insert(blocks.begin(), blocks.end());
+		func->adjacent.insert(adjacent.begin(), adjacent.end());
+		func->jtable.insert(jtable.begin(), jtable.end());
+
+		const u64 key = rec.addr | u64{ func->data[0] } << 32;
+
+		if (!find(func->data.data(), key, rec.size))
+		{
+			m_db.emplace(key, std::move(func));
+		}
+	}
+
+	// Discard incomplete or corrupted tail
+	if (pos != m_file.size())
+	{
+		LOG_ERROR(SPU, "SPU database is damaged at 0x%llx (size=0x%llx)", pos, m_file.size());
+		m_file.trunc(pos);
+	}
+
+	m_file.seek(pos);
+}
+
+void SPUDatabase::save(const spu_function_t& func)
+{
+	if (!m_file)
+	{
+		return;
+	}
+
+	spu_db_record rec;
+	rec.addr     = func.addr;
+	rec.size     = func.size;
+	rec.blocks   = ::size32(func.blocks);
+	rec.adjacent = ::size32(func.adjacent);
+	rec.jtable   = ::size32(func.jtable);
+	rec.flags    = func.does_reset_stack ? 1 : 0;
+
+	std::vector<u32> data;
+	data.reserve(sizeof(rec) / 4 + func.size / 4 + func.blocks.size() + func.adjacent.size() + func.jtable.size());
+	data.resize(sizeof(rec) / 4);
+	std::memcpy(data.data(), &rec, sizeof(rec));
+	data.insert(data.end(), reinterpret_cast<const u32*>(func.data.data()), reinterpret_cast<const u32*>(func.data.data()) + func.size / 4);
+	data.insert(data.end(), func.blocks.begin(), func.blocks.end());
+	data.insert(data.end(), func.adjacent.begin(), func.adjacent.end());
+	data.insert(data.end(), func.jtable.begin(), func.jtable.end());
+
+	// Write the whole record at once
+	m_file.write(data);
+}
+
+void SPUDatabase::precompile(spu_recompiler_base& rec)
+{
+	if (m_precompiled.exchange(true))
+	{
+		return;
+	}
+
+	std::vector<std::shared_ptr<spu_function_t>> funcs;
+	{
+		reader_lock lock(m_mutex);
+
+		for (auto& pair : m_db)
+		{
+			funcs.emplace_back(pair.second);
+		}
+	}
+
+	// Compile functions in batches
+	std::vector<spu_function_t*> batch;
+
+	for (std::size_t i = 0; i < funcs.size() && !Emu.IsStopped(); i += batch.size())
+	{
+		batch.clear();
+
+		for (std::size_t j = i; j < funcs.size() && batch.size() < spu_recompiler_base::batch_max; j++)
+		{
+			batch.emplace_back(funcs[j].get());
+		}
+
+		rec.compile_all(batch);
+	}
+
+	if (!funcs.empty())
+	{
+		LOG_SUCCESS(SPU, "SPU Database: %u functions precompiled", funcs.size());
+	}
 }
 
 spu_function_t* SPUDatabase::analyse(const be_t<u32>* ls, u32 entry, u32 max_limit)
@@ -326,6 +475,9 @@ spu_function_t* SPUDatabase::analyse(const be_t<u32>* ls, u32 entry, u32 max_lim
 
 		// Add function to the database
 		m_db.emplace(key, func);
+
+		// Store it in the database file
+		save(*func);
 	}
 
 	LOG_NOTICE(SPU, "Function detected [0x%05x-0x%05x] (size=0x%x)", func->addr, func->addr + func->size, func->size);
@@ -270,8 +270,10 @@ struct spu_function_t
 	// Whether ila $SP,* instruction found
 	bool does_reset_stack;
 
-	// Pointer to the compiled function
-	u32(*compiled)(SPUThread* _spu, be_t<u32>* _ls) = nullptr;
+	using func_t = u32(*)(SPUThread* _spu, be_t<u32>* _ls);
+
+	// Pointer to the compiled function (published by the compiler thread)
+	atomic_t<func_t> compiled{nullptr};
 
 	spu_function_t(u32 addr, u32 size)
 		: addr(addr)
@@ -288,13 +290,28 @@ class SPUDatabase final : spu_itype
 	// All registered functions (uses addr and first instruction as a key)
 	std::unordered_multimap<u64, std::shared_ptr<spu_function_t>> m_db;
 
+	// Database file in the cache directory (new functions are appended)
+	fs::file m_file;
+
+	// Set when functions loaded from the database file have been compiled
+	atomic_t<bool> m_precompiled{false};
+
 	// For internal use
 	spu_function_t* find(const be_t<u32>* data, u64 key, u32 max_size);
 
+	// Load functions from the database file
+	void load();
+
+	// Append function to the database file (must be called under writer lock)
+	void save(const spu_function_t& func);
+
 public:
 	SPUDatabase();
 	~SPUDatabase();
 
 	// Try to retrieve SPU function information
 	spu_function_t* analyse(const be_t<u32>* ls, u32 entry, u32 limit = 0x40000);
+
+	// Compile all functions loaded from the database file (only first call has effect)
+	void precompile(class spu_recompiler_base& rec);
 };
@@ -364,7 +364,9 @@ void spu_interpreter::STOPD(SPUThread& spu, spu_opcode_t op)
 
 void spu_interpreter::STQX(SPUThread& spu, spu_opcode_t op)
 {
-	spu._ref<v128>((spu.gpr[op.ra]._u32[3] + spu.gpr[op.rb]._u32[3]) & 0x3fff0) = spu.gpr[op.rt];
+	const u32 lsa = (spu.gpr[op.ra]._u32[3] + spu.gpr[op.rb]._u32[3]) & 0x3fff0;
+	spu._ref<v128>(lsa) = spu.gpr[op.rt];
+	spu.ls_store(lsa);
 }
 
 void spu_interpreter::BI(SPUThread& spu, spu_opcode_t op)
@@ -1084,6 +1086,7 @@ void spu_interpreter::BRZ(SPUThread& spu, spu_opcode_t op)
 void spu_interpreter::STQA(SPUThread& spu, spu_opcode_t op)
 {
 	spu._ref<v128>(spu_ls_target(0, op.i16)) = spu.gpr[op.rt];
+	spu.ls_store(spu_ls_target(0, op.i16));
 }
 
 void spu_interpreter::BRNZ(SPUThread& spu, spu_opcode_t op)
@@ -1113,6 +1116,7 @@ void spu_interpreter::BRHNZ(SPUThread& spu, spu_opcode_t op)
 void spu_interpreter::STQR(SPUThread& spu, spu_opcode_t op)
 {
 	spu._ref<v128>(spu_ls_target(spu.pc, op.i16)) = spu.gpr[op.rt];
+	spu.ls_store(spu_ls_target(spu.pc, op.i16));
 }
 
 void spu_interpreter::BRA(SPUThread& spu, spu_opcode_t op)
@@ -1227,7 +1231,9 @@ void spu_interpreter::AHI(SPUThread& spu, spu_opcode_t op)
 
 void spu_interpreter::STQD(SPUThread& spu, spu_opcode_t op)
 {
-	spu._ref<v128>((spu.gpr[op.ra]._s32[3] + (op.si10 << 4)) & 0x3fff0) = spu.gpr[op.rt];
+	const u32 lsa = (spu.gpr[op.ra]._s32[3] + (op.si10 << 4)) & 0x3fff0;
+	spu._ref<v128>(lsa) = spu.gpr[op.rt];
+	spu.ls_store(lsa);
 }
 
 void spu_interpreter::LQD(SPUThread& spu, spu_opcode_t op)
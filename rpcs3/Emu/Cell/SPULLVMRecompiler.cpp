@@ -0,0 +1,951 @@
+#include "stdafx.h"
+
+#ifdef LLVM_AVAILABLE
+
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Crypto/sha1.h"
+
+#include "SPUThread.h"
+#include "SPUInterpreter.h"
+#include "SPULLVMRecompiler.h"
+
+#include <map>
+
+#include "restore_new.h"
+#ifdef _MSC_VER
+#pragma warning(push, 0)
+#endif
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+#include "define_new_memleakdetect.h"
+
+#include "Utilities/JIT.h"
+
+using namespace llvm;
+
+const spu_decoder<spu_itype> s_spu_itype;
+const spu_decoder<spu_interpreter_fast> s_spu_interpreter;
+
+// Interpreter fallback (decodes the opcode itself, so the generated code doesn't contain host addresses)
+static u32 spu_llvm_interpreter(SPUThread* _spu, u32 opcode) noexcept
+{
+	return spu_recompiler_base::interpreter_call(_spu, opcode, s_spu_interpreter.decode(opcode));
+}
+
+// Process thread state on loop back-edges (returns 0 to continue)
+static u32 spu_llvm_check(SPUThread* _spu, u32 pc) noexcept
+{
+	_spu->pc = pc;
+
+	try
+	{
+		if (_spu->check_state())
+		{
+			return 0x2000000 | pc;
+		}
+
+		return 0;
+	}
+	catch (...)
+	{
+		_spu->pending_exception = std::current_exception();
+		return 0x1000000 | pc;
+	}
+}
+
+// SPU function translator (function -> LLVM IR)
+class spu_llvm_translator final
+{
+	// LLVM context
+	LLVMContext& m_context;
+
+	// Module to which the function is output to
+	Module* const m_module;
+
+	// Source function
+	const spu_function_t& m_func;
+
+	// IR builder
+	IRBuilder<>* m_ir;
+
+	// LLVM function
+	Function* m_function;
+
+	// Function arguments (SPUThread* and LS base, both as i8*)
+	Value* m_thread;
+	Value* m_lsptr;
+
+	// Local copies (allocas) of the registers accessed by the function
+	std::array<Value*, 128> m_gpr{};
+
+	// Return value (alloca) and the common exit block which writes the registers back
+	Value* m_ret;
+	BasicBlock* m_exit;
+
+	// Block entries
+	std::map<u32, BasicBlock*> m_blocks;
+
+	// Current position
+	u32 m_pos;
+
+	// Get integer vector type of 128 bits with specified element size
+	VectorType* vtype(u32 bits)
+	{
+		return VectorType::get(m_ir->getIntNTy(bits), 128 / bits);
+	}
+
+	// Get integer vector constant with all elements set to the value
+	Constant* splat(u32 bits, u64 value)
+	{
+		return ConstantInt::get(vtype(bits), bits == 64 ? value : value & ((1ull << bits) - 1));
+	}
+
+	// Get vector constant from v128 (register layout)
+	Constant* make_const(const v128& value)
+	{
+		const u32 data[4]{value._u32[0], value._u32[1], value._u32[2], value._u32[3]};
+		return ConstantDataVector::get(m_context, data);
+	}
+
+	// Get pointer to SPUThread member at specified offset
+	Value* spu_ptr(u32 offset, Type* type)
+	{
+		return m_ir->CreateBitCast(m_ir->CreateConstGEP1_32(m_thread, offset), type->getPointerTo());
+	}
+
+	// Get register value as integer vector
+	Value* get_vr(u32 index, u32 bits = 32)
+	{
+		return m_ir->CreateBitCast(m_ir->CreateLoad(m_gpr[index]), vtype(bits));
+	}
+
+	// Get register value as float vector
+	Value* get_vf(u32 index)
+	{
+		return m_ir->CreateBitCast(m_ir->CreateLoad(m_gpr[index]), VectorType::get(m_ir->getFloatTy(), 4));
+	}
+
+	// Get preferred slot value (word or halfword)
+	Value* get_scalar(u32 index, u32 bits = 32)
+	{
+		return m_ir->CreateExtractElement(get_vr(index, bits), m_ir->getInt32(bits == 16 ? 6 : 3));
+	}
+
+	void set_vr(u32 index, Value* value)
+	{
+		m_ir->CreateStore(m_ir->CreateBitCast(value, vtype(32)), m_gpr[index]);
+	}
+
+	// Write register back to SPUThread::gpr
+	void flush_gpr(u32 index)
+	{
+		if (m_gpr[index])
+		{
+			m_ir->CreateStore(m_ir->CreateLoad(m_gpr[index]), spu_ptr(offset32(&SPUThread::gpr, index), vtype(32)));
+		}
+	}
+
+	// Read register from SPUThread::gpr
+	void reload_gpr(u32 index)
+	{
+		if (m_gpr[index])
+		{
+			m_ir->CreateStore(m_ir->CreateLoad(spu_ptr(offset32(&SPUThread::gpr, index), vtype(32))), m_gpr[index]);
+		}
+	}
+
+	// Reverse byte order of 16-byte vector
+	Value* byteswap(Value* value)
+	{
+		const u32 mask[16]{15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+		const auto data = m_ir->CreateBitCast(value, vtype(8));
+		return m_ir->CreateShuffleVector(data, UndefValue::get(data->getType()), ConstantDataVector::get(m_context, mask));
+	}
+
+	// Get pointer to LS quadword (address must be masked)
+	Value* ls_ptr(Value* addr)
+	{
+		return m_ir->CreateBitCast(m_ir->CreateGEP(m_lsptr, m_ir->CreateZExt(addr, m_ir->getInt64Ty())), vtype(8)->getPointerTo());
+	}
+
+	Value* read_ls(Value* addr)
+	{
+		return byteswap(m_ir->CreateAlignedLoad(ls_ptr(addr), 16));
+	}
+
+	void write_ls(Value* addr, Value* value)
+	{
+		m_ir->CreateAlignedStore(byteswap(value), ls_ptr(addr), 16);
+
+		// Mark LS page as modified if it contains compiled code (see SPUThread::ls_store)
+		const auto page = m_ir->CreateZExt(m_ir->CreateLShr(addr, 12), m_ir->getInt64Ty());
+		const auto mask = m_ir->CreateLoad(spu_ptr(offset32(&SPUThread::ls_code_mask), m_ir->getInt64Ty()));
+		const auto code = m_ir->CreateTrunc(m_ir->CreateLShr(mask, page), m_ir->getInt1Ty());
+		const auto mark = BasicBlock::Create(m_context, "", m_function);
+		const auto next = BasicBlock::Create(m_context, "", m_function);
+		m_ir->CreateCondBr(code, mark, next);
+		m_ir->SetInsertPoint(mark);
+		const auto stamp = m_ir->CreateAtomicRMW(AtomicRMWInst::Add, spu_ptr(offset32(&SPUThread::ls_stamp), m_ir->getInt64Ty()), m_ir->getInt64(1), AtomicOrdering::SequentiallyConsistent);
+		const auto stamps = spu_ptr(offset32(&SPUThread::ls_page_stamp), m_ir->getInt64Ty());
+		m_ir->CreateStore(m_ir->CreateAdd(stamp, m_ir->getInt64(1)), m_ir->CreateGEP(stamps, page));
+		m_ir->CreateBr(next);
+		m_ir->SetInsertPoint(next);
+	}
+
+	// Call external function (returns u32)
+	template <typename... Args>
+	Value* call(const char* name, Args... args)
+	{
+		const std::vector<Value*> list{args...};
+		std::vector<Type*> types;
+
+		for (auto arg : list)
+		{
+			types.emplace_back(arg->getType());
+		}
+
+		return m_ir->CreateCall(m_module->getOrInsertFunction(name, FunctionType::get(m_ir->getInt32Ty(), types, false)), list);
+	}
+
+	// Finish the function returning specified PC value (with flags)
+	void ret_pc(Value* value)
+	{
+		m_ir->CreateStore(value, m_ret);
+		m_ir->CreateBr(m_exit);
+	}
+
+	// Return if the value is not zero, continue otherwise
+	void check_return(Value* value)
+	{
+		const auto _ret = BasicBlock::Create(m_context, "", m_function);
+		const auto next = BasicBlock::Create(m_context, "", m_function);
+		m_ir->CreateCondBr(m_ir->CreateIsNotNull(value), _ret, next);
+		m_ir->SetInsertPoint(_ret);
+		ret_pc(value);
+		m_ir->SetInsertPoint(next);
+	}
+
+	void set_pc(Value* value)
+	{
+		m_ir->CreateStore(value, spu_ptr(offset32(&SPUThread::pc), m_ir->getInt32Ty()));
+	}
+
+	// Execute the instruction in the interpreter
+	void interpreter_call(spu_opcode_t op)
+	{
+		// Write back all registers which can be accessed
+		flush_gpr(op.rt);
+		flush_gpr(op.ra);
+		flush_gpr(op.rb);
+		flush_gpr(op.rt4);
+
+		set_pc(m_ir->getInt32(m_pos));
+		const auto result = call("spu_interpreter", m_thread, m_ir->getInt32(op.opcode));
+
+		// Reload registers which can be modified
+		reload_gpr(op.rt);
+		reload_gpr(op.rt4);
+
+		check_return(result);
+	}
+
+	// Call another function (PC must be set), link register must be already set
+	void function_call()
+	{
+		for (u32 i = 0; i < 128; i++)
+		{
+			flush_gpr(i);
+		}
+
+		const auto result = call("spu_function_call", m_thread, m_ir->getInt32(spu_branch_target(m_pos + 4)));
+
+		for (u32 i = 0; i < 128; i++)
+		{
+			reload_gpr(i);
+		}
+
+		check_return(result);
+	}
+
+	// Set link register value
+	void set_link(u32 index)
+	{
+		set_vr(index, make_const(v128::from32r(spu_branch_target(m_pos + 4))));
+	}
+
+	// Branch to the local block or return
+	void branch(u32 target)
+	{
+		const auto found = m_blocks.find(target);
+
+		if (found == m_blocks.end())
+		{
+			if (target >= m_func.addr && target < m_func.addr + m_func.size)
+			{
+				LOG_ERROR(SPU, "Local block not registered (0x%05x)", target);
+			}
+
+			ret_pc(m_ir->getInt32(target));
+			return;
+		}
+
+		if (target > m_pos)
+		{
+			m_ir->CreateBr(found->second);
+			return;
+		}
+
+		// Test thread state on back-edges, so loops remain interruptible
+		const auto state = m_ir->CreateLoad(spu_ptr(offset32(&SPUThread::state), m_ir->getInt32Ty()), true);
+		const auto check = BasicBlock::Create(m_context, "", m_function);
+		m_ir->CreateCondBr(m_ir->CreateIsNull(state), found->second, check);
+		m_ir->SetInsertPoint(check);
+
+		const auto result = call("spu_check", m_thread, m_ir->getInt32(target));
+		const auto _ret = BasicBlock::Create(m_context, "", m_function);
+		m_ir->CreateCondBr(m_ir->CreateIsNull(result), found->second, _ret);
+		m_ir->SetInsertPoint(_ret);
+		ret_pc(result);
+	}
+
+	// Conditional branch
+	void branch_if(Value* cond, u32 target)
+	{
+		const auto taken = BasicBlock::Create(m_context, "", m_function);
+		const auto next = BasicBlock::Create(m_context, "", m_function);
+		m_ir->CreateCondBr(cond, taken, next);
+		m_ir->SetInsertPoint(taken);
+		branch(target);
+		m_ir->SetInsertPoint(next);
+	}
+
+	// Indirect branch (resolves jump table entries)
+	void branch_indirect(spu_opcode_t op, Value* addr)
+	{
+		addr = m_ir->CreateAnd(addr, 0x3fffc);
+
+		if (op.d || op.e)
+		{
+			// Interrupt flags neutralize jump table
+			ret_pc(m_ir->CreateOr(addr, op.e << 26 | op.d << 27));
+			return;
+		}
+
+		const auto _ret = BasicBlock::Create(m_context, "", m_function);
+		const auto _sw = m_ir->CreateSwitch(addr, _ret, ::size32(m_func.jtable));
+
+		for (const u32 target : m_func.jtable)
+		{
+			const auto found = m_blocks.find(target);
+
+			if (found != m_blocks.end())
+			{
+				_sw->addCase(m_ir->getInt32(target), found->second);
+			}
+			else
+			{
+				LOG_ERROR(SPU, "Unable to add jump table entry (0x%05x)", target);
+			}
+		}
+
+		m_ir->SetInsertPoint(_ret);
+		ret_pc(addr);
+	}
+
+	// Conditional indirect branch
+	void branch_indirect_if(spu_opcode_t op, Value* cond)
+	{
+		const auto taken = BasicBlock::Create(m_context, "", m_function);
+		const auto next = BasicBlock::Create(m_context, "", m_function);
+		const auto addr = get_scalar(op.ra);
+		m_ir->CreateCondBr(cond, taken, next);
+		m_ir->SetInsertPoint(taken);
+		branch_indirect(op, addr);
+		m_ir->SetInsertPoint(next);
+	}
+
+	// Extend comparison result to the mask
+	Value* mask(Value* cmp, u32 bits)
+	{
+		return m_ir->CreateSExt(cmp, vtype(bits));
+	}
+
+	Value* rotl(Value* arg, u32 bits, u32 n)
+	{
+		return !n ? arg : m_ir->CreateOr(m_ir->CreateShl(arg, splat(bits, n)), m_ir->CreateLShr(arg, splat(bits, bits - n)));
+	}
+
+	// Logical shift right with saturation (like psrl)
+	Value* lshr(Value* arg, u32 bits, u32 n)
+	{
+		return n >= bits ? splat(bits, 0) : m_ir->CreateLShr(arg, splat(bits, n));
+	}
+
+	// Arithmetic shift right with saturation (like psra)
+	Value* ashr(Value* arg, u32 bits, u32 n)
+	{
+		return m_ir->CreateAShr(arg, splat(bits, std::min(n, bits - 1)));
+	}
+
+	// Shift left with saturation (like psll)
+	Value* shl(Value* arg, u32 bits, u32 n)
+	{
+		return n >= bits ? splat(bits, 0) : m_ir->CreateShl(arg, splat(bits, n));
+	}
+
+	// Translate single instruction
+	void translate_op(spu_opcode_t op);
+
+public:
+	spu_llvm_translator(LLVMContext& context, Module* module, const spu_function_t& func)
+		: m_context(context)
+		, m_module(module)
+		, m_func(func)
+	{
+	}
+
+	// Translate the whole function
+	Function* translate(const std::string& name);
+};
+
+Function* spu_llvm_translator::translate(const std::string& name)
+{
+	const auto i8ptr = Type::getInt8PtrTy(m_context);
+
+	m_function = Function::Create(FunctionType::get(Type::getInt32Ty(m_context), {i8ptr, i8ptr}, false), GlobalValue::ExternalLinkage, name, m_module);
+	m_function->addAttribute(1, Attribute::NoAlias);
+	m_function->addAttribute(2, Attribute::NoAlias);
+
+	auto arg = m_function->arg_begin();
+	m_thread = &*arg++;
+	m_lsptr = &*arg;
+
+	IRBuilder<> irb(BasicBlock::Create(m_context, "__entry", m_function));
+	m_ir = &irb;
+
+	// Allocate local copies of all registers accessed (must be done in the entry block)
+	for (const u32 data : m_func.data)
+	{
+		const spu_opcode_t op{data};
+
+		for (const u32 reg : {+op.rt, +op.ra, +op.rb, +op.rt4})
+		{
+			if (!m_gpr[reg])
+			{
+				m_gpr[reg] = m_ir->CreateAlloca(vtype(32));
+			}
+		}
+	}
+
+	m_ret = m_ir->CreateAlloca(m_ir->getInt32Ty());
+
+	for (u32 i = 0; i < 128; i++)
+	{
+		reload_gpr(i);
+	}
+
+	// Create blocks
+	for (const u32 addr : m_func.blocks)
+	{
+		if (addr < m_func.addr || addr >= m_func.addr + m_func.size || addr % 4)
+		{
+			fmt::throw_exception("Invalid function block entry (0x%05x)" HERE, addr);
+		}
+
+		m_blocks.emplace(addr, BasicBlock::Create(m_context, fmt::format("b_%05x", addr), m_function));
+	}
+
+	m_exit = BasicBlock::Create(m_context, "__exit", m_function);
+
+	m_ir->CreateBr(m_blocks.at(m_func.addr));
+
+	for (m_pos = m_func.addr; m_pos < m_func.addr + m_func.size; m_pos += 4)
+	{
+		const auto found = m_blocks.find(m_pos);
+
+		if (found != m_blocks.end())
+		{
+			// Fallthrough to the next block
+			if (!m_ir->GetInsertBlock()->getTerminator())
+			{
+				m_ir->CreateBr(found->second);
+			}
+
+			m_ir->SetInsertPoint(found->second);
+		}
+		else if (m_ir->GetInsertBlock()->getTerminator())
+		{
+			// Unreachable code (removed by optimization passes)
+			m_ir->SetInsertPoint(BasicBlock::Create(m_context, "", m_function));
+		}
+
+		translate_op({m_func.data[(m_pos - m_func.addr) / 4]});
+	}
+
+	// Generate default function end (go to the next address)
+	if (!m_ir->GetInsertBlock()->getTerminator())
+	{
+		ret_pc(m_ir->getInt32(spu_branch_target(m_pos)));
+	}
+
+	// Write back registers and return
+	m_ir->SetInsertPoint(m_exit);
+
+	for (u32 i = 0; i < 128; i++)
+	{
+		flush_gpr(i);
+	}
+
+	m_ir->CreateRet(m_ir->CreateLoad(m_ret));
+
+	return m_function;
+}
+
+void spu_llvm_translator::translate_op(spu_opcode_t op)
+{
+	switch (const auto type = s_spu_itype.decode(op.opcode))
+	{
+	case spu_itype::LNOP:
+	case spu_itype::NOP:
+	case spu_itype::HBR:
+	case spu_itype::HBRA:
+	case spu_itype::HBRR:
+	{
+		return;
+	}
+	case spu_itype::SYNC:
+	case spu_itype::DSYNC:
+	{
+		m_ir->CreateFence(AtomicOrdering::SequentiallyConsistent);
+		return;
+	}
+
+	// Memory Load/Store Instructions
+	case spu_itype::LQD:
+	{
+		set_vr(op.rt, read_ls(m_ir->CreateAnd(m_ir->CreateAdd(get_scalar(op.ra), m_ir->getInt32(op.si10 << 4)), 0x3fff0)));
+		return;
+	}
+	case spu_itype::LQX:
+	{
+		set_vr(op.rt, read_ls(m_ir->CreateAnd(m_ir->CreateAdd(get_scalar(op.ra), get_scalar(op.rb)), 0x3fff0)));
+		return;
+	}
+	case spu_itype::LQA:
+	{
+		set_vr(op.rt, read_ls(m_ir->getInt32(spu_ls_target(0, op.i16))));
+		return;
+	}
+	case spu_itype::LQR:
+	{
+		set_vr(op.rt, read_ls(m_ir->getInt32(spu_ls_target(m_pos, op.i16))));
+		return;
+	}
+	case spu_itype::STQD:
+	{
+		write_ls(m_ir->CreateAnd(m_ir->CreateAdd(get_scalar(op.ra), m_ir->getInt32(op.si10 << 4)), 0x3fff0), get_vr(op.rt));
+		return;
+	}
+	case spu_itype::STQX:
+	{
+		write_ls(m_ir->CreateAnd(m_ir->CreateAdd(get_scalar(op.ra), get_scalar(op.rb)), 0x3fff0), get_vr(op.rt));
+		return;
+	}
+	case spu_itype::STQA:
+	{
+		write_ls(m_ir->getInt32(spu_ls_target(0, op.i16)), get_vr(op.rt));
+		return;
+	}
+	case spu_itype::STQR:
+	{
+		write_ls(m_ir->getInt32(spu_ls_target(m_pos, op.i16)), get_vr(op.rt));
+		return;
+	}
+
+	// Constant Formation Instructions
+	case spu_itype::IL: set_vr(op.rt, splat(32, op.si16)); return;
+	case spu_itype::ILH: set_vr(op.rt, splat(16, op.i16)); return;
+	case spu_itype::ILHU: set_vr(op.rt, splat(32, op.i16 << 16)); return;
+	case spu_itype::ILA: set_vr(op.rt, splat(32, op.i18)); return;
+	case spu_itype::IOHL: set_vr(op.rt, m_ir->CreateOr(get_vr(op.rt), splat(32, op.i16))); return;
+	case spu_itype::FSMBI: set_vr(op.rt, make_const(g_spu_imm.fsmb[op.i16])); return;
+
+	// Integer and Logical Instructions
+	case spu_itype::A: set_vr(op.rt, m_ir->CreateAdd(get_vr(op.ra), get_vr(op.rb))); return;
+	case spu_itype::AH: set_vr(op.rt, m_ir->CreateAdd(get_vr(op.ra, 16), get_vr(op.rb, 16))); return;
+	case spu_itype::AI: set_vr(op.rt, m_ir->CreateAdd(get_vr(op.ra), splat(32, op.si10))); return;
+	case spu_itype::AHI: set_vr(op.rt, m_ir->CreateAdd(get_vr(op.ra, 16), splat(16, op.si10))); return;
+	case spu_itype::SF: set_vr(op.rt, m_ir->CreateSub(get_vr(op.rb), get_vr(op.ra))); return;
+	case spu_itype::SFH: set_vr(op.rt, m_ir->CreateSub(get_vr(op.rb, 16), get_vr(op.ra, 16))); return;
+	case spu_itype::SFI: set_vr(op.rt, m_ir->CreateSub(splat(32, op.si10), get_vr(op.ra))); return;
+	case spu_itype::SFHI: set_vr(op.rt, m_ir->CreateSub(splat(16, op.si10), get_vr(op.ra, 16))); return;
+	case spu_itype::MPY: set_vr(op.rt, m_ir->CreateMul(m_ir->CreateAShr(m_ir->CreateShl(get_vr(op.ra), 16), 16), m_ir->CreateAShr(m_ir->CreateShl(get_vr(op.rb), 16), 16))); return;
+	case spu_itype::MPYU: set_vr(op.rt, m_ir->CreateMul(m_ir->CreateAnd(get_vr(op.ra), 0xffff), m_ir->CreateAnd(get_vr(op.rb), 0xffff))); return;
+	case spu_itype::MPYI: set_vr(op.rt, m_ir->CreateMul(m_ir->CreateAShr(m_ir->CreateShl(get_vr(op.ra), 16), 16), splat(32, op.si10))); return;
+	case spu_itype::MPYUI: set_vr(op.rt, m_ir->CreateMul(m_ir->CreateAnd(get_vr(op.ra), 0xffff), splat(32, op.si10 & 0xffff))); return;
+	case spu_itype::AND: set_vr(op.rt, m_ir->CreateAnd(get_vr(op.ra), get_vr(op.rb))); return;
+	case spu_itype::ANDC: set_vr(op.rt, m_ir->CreateAnd(get_vr(op.ra), m_ir->CreateNot(get_vr(op.rb)))); return;
+	case spu_itype::ANDBI: set_vr(op.rt, m_ir->CreateAnd(get_vr(op.ra, 8), splat(8, op.i8))); return;
+	case spu_itype::ANDHI: set_vr(op.rt, m_ir->CreateAnd(get_vr(op.ra, 16), splat(16, op.si10))); return;
+	case spu_itype::ANDI: set_vr(op.rt, m_ir->CreateAnd(get_vr(op.ra), splat(32, op.si10))); return;
+	case spu_itype::OR: set_vr(op.rt, m_ir->CreateOr(get_vr(op.ra), get_vr(op.rb))); return;
+	case spu_itype::ORC: set_vr(op.rt, m_ir->CreateOr(get_vr(op.ra), m_ir->CreateNot(get_vr(op.rb)))); return;
+	case spu_itype::ORBI: set_vr(op.rt, m_ir->CreateOr(get_vr(op.ra, 8), splat(8, op.i8))); return;
+	case spu_itype::ORHI: set_vr(op.rt, m_ir->CreateOr(get_vr(op.ra, 16), splat(16, op.si10))); return;
+	case spu_itype::ORI: set_vr(op.rt, m_ir->CreateOr(get_vr(op.ra), splat(32, op.si10))); return;
+	case spu_itype::XOR: set_vr(op.rt, m_ir->CreateXor(get_vr(op.ra), get_vr(op.rb))); return;
+	case spu_itype::XORBI: set_vr(op.rt, m_ir->CreateXor(get_vr(op.ra, 8), splat(8, op.i8))); return;
+	case spu_itype::XORHI: set_vr(op.rt, m_ir->CreateXor(get_vr(op.ra, 16), splat(16, op.si10))); return;
+	case spu_itype::XORI: set_vr(op.rt, m_ir->CreateXor(get_vr(op.ra), splat(32, op.si10))); return;
+	case spu_itype::NAND: set_vr(op.rt, m_ir->CreateNot(m_ir->CreateAnd(get_vr(op.ra), get_vr(op.rb)))); return;
+	case spu_itype::NOR: set_vr(op.rt, m_ir->CreateNot(m_ir->CreateOr(get_vr(op.ra), get_vr(op.rb)))); return;
+	case spu_itype::EQV: set_vr(op.rt, m_ir->CreateNot(m_ir->CreateXor(get_vr(op.ra), get_vr(op.rb)))); return;
+	case spu_itype::SELB:
+	{
+		const auto c = get_vr(op.rc);
+		set_vr(op.rt4, m_ir->CreateOr(m_ir->CreateAnd(c, get_vr(op.rb)), m_ir->CreateAnd(m_ir->CreateNot(c), get_vr(op.ra))));
+		return;
+	}
+
+	// Shift and Rotate Instructions (immediate forms)
+	case spu_itype::SHLI: set_vr(op.rt, shl(get_vr(op.ra), 32, op.i7 & 0x3f)); return;
+	case spu_itype::SHLHI: set_vr(op.rt, shl(get_vr(op.ra, 16), 16, op.i7 & 0x1f)); return;
+	case spu_itype::ROTI: set_vr(op.rt, rotl(get_vr(op.ra), 32, op.i7 & 0x1f)); return;
+	case spu_itype::ROTHI: set_vr(op.rt, rotl(get_vr(op.ra, 16), 16, op.i7 & 0xf)); return;
+	case spu_itype::ROTMI: set_vr(op.rt, lshr(get_vr(op.ra), 32, (0 - op.i7) & 0x3f)); return;
+	case spu_itype::ROTHMI: set_vr(op.rt, lshr(get_vr(op.ra, 16), 16, (0 - op.i7) & 0x1f)); return;
+	case spu_itype::ROTMAI: set_vr(op.rt, ashr(get_vr(op.ra), 32, (0 - op.i7) & 0x3f)); return;
+	case spu_itype::ROTMAHI: set_vr(op.rt, ashr(get_vr(op.ra, 16), 16, (0 - op.i7) & 0x1f)); return;
+
+	// Compare Instructions
+	case spu_itype::CEQ: set_vr(op.rt, mask(m_ir->CreateICmpEQ(get_vr(op.ra), get_vr(op.rb)), 32)); return;
+	case spu_itype::CEQH: set_vr(op.rt, mask(m_ir->CreateICmpEQ(get_vr(op.ra, 16), get_vr(op.rb, 16)), 16)); return;
+	case spu_itype::CEQB: set_vr(op.rt, mask(m_ir->CreateICmpEQ(get_vr(op.ra, 8), get_vr(op.rb, 8)), 8)); return;
+	case spu_itype::CEQI: set_vr(op.rt, mask(m_ir->CreateICmpEQ(get_vr(op.ra), splat(32, op.si10)), 32)); return;
+	case spu_itype::CEQHI: set_vr(op.rt, mask(m_ir->CreateICmpEQ(get_vr(op.ra, 16), splat(16, op.si10)), 16)); return;
+	case spu_itype::CEQBI: set_vr(op.rt, mask(m_ir->CreateICmpEQ(get_vr(op.ra, 8), splat(8, op.i8)), 8)); return;
+	case spu_itype::CGT: set_vr(op.rt, mask(m_ir->CreateICmpSGT(get_vr(op.ra), get_vr(op.rb)), 32)); return;
+	case spu_itype::CGTH: set_vr(op.rt, mask(m_ir->CreateICmpSGT(get_vr(op.ra, 16), get_vr(op.rb, 16)), 16)); return;
+	case spu_itype::CGTB: set_vr(op.rt, mask(m_ir->CreateICmpSGT(get_vr(op.ra, 8), get_vr(op.rb, 8)), 8)); return;
+	case spu_itype::CGTI: set_vr(op.rt, mask(m_ir->CreateICmpSGT(get_vr(op.ra), splat(32, op.si10)), 32)); return;
+	case spu_itype::CGTHI: set_vr(op.rt, mask(m_ir->CreateICmpSGT(get_vr(op.ra, 16), splat(16, op.si10)), 16)); return;
+	case spu_itype::CGTBI: set_vr(op.rt, mask(m_ir->CreateICmpSGT(get_vr(op.ra, 8), splat(8, op.i8)), 8)); return;
+	case spu_itype::CLGT: set_vr(op.rt, mask(m_ir->CreateICmpUGT(get_vr(op.ra), get_vr(op.rb)), 32)); return;
+	case spu_itype::CLGTH: set_vr(op.rt, mask(m_ir->CreateICmpUGT(get_vr(op.ra, 16), get_vr(op.rb, 16)), 16)); return;
+	case spu_itype::CLGTB: set_vr(op.rt, mask(m_ir->CreateICmpUGT(get_vr(op.ra, 8), get_vr(op.rb, 8)), 8)); return;
+	case spu_itype::CLGTI: set_vr(op.rt, mask(m_ir->CreateICmpUGT(get_vr(op.ra), splat(32, op.si10)), 32)); return;
+	case spu_itype::CLGTHI: set_vr(op.rt, mask(m_ir->CreateICmpUGT(get_vr(op.ra, 16), splat(16, op.si10)), 16)); return;
+	case spu_itype::CLGTBI: set_vr(op.rt, mask(m_ir->CreateICmpUGT(get_vr(op.ra, 8), splat(8, op.i8)), 8)); return;
+
+	// Floating-Point Instructions (same semantics as the fast interpreter)
+	case spu_itype::FA: set_vr(op.rt, m_ir->CreateFAdd(get_vf(op.ra), get_vf(op.rb))); return;
+	case spu_itype::FS: set_vr(op.rt, m_ir->CreateFSub(get_vf(op.ra), get_vf(op.rb))); return;
+
+	// Branch Instructions
+	case spu_itype::BR:
+	case spu_itype::BRA:
+	{
+		const u32 target = spu_branch_target(type == spu_itype::BR ? m_pos : 0, op.i16);
+
+		if (target == m_pos)
+		{
+			break;
+		}
+
+		branch(target);
+		return;
+	}
+	case spu_itype::BRZ:
+	case spu_itype::BRNZ:
+	case spu_itype::BRHZ:
+	case spu_itype::BRHNZ:
+	{
+		const u32 target = spu_branch_target(m_pos, op.i16);
+
+		if (target == m_pos)
+		{
+			break;
+		}
+
+		const bool half = type == spu_itype::BRHZ || type == spu_itype::BRHNZ;
+		const auto value = get_scalar(op.rt, half ? 16 : 32);
+		branch_if(type == spu_itype::BRZ || type == spu_itype::BRHZ ? m_ir->CreateIsNull(value) : m_ir->CreateIsNotNull(value), target);
+		return;
+	}
+	case spu_itype::BRSL:
+	case spu_itype::BRASL:
+	{
+		const u32 target = spu_branch_target(type == spu_itype::BRSL ? m_pos : 0, op.i16);
+
+		if (target == m_pos)
+		{
+			break;
+		}
+
+		set_link(op.rt);
+
+		if (target == spu_branch_target(m_pos + 4))
+		{
+			// Branch-to-next
+			return;
+		}
+
+		set_pc(m_ir->getInt32(target));
+		function_call();
+		return;
+	}
+	case spu_itype::BI:
+	{
+		branch_indirect(op, get_scalar(op.ra));
+		return;
+	}
+	case spu_itype::IRET:
+	{
+		branch_indirect(op, m_ir->CreateLoad(spu_ptr(offset32(&SPUThread::srr0), m_ir->getInt32Ty())));
+		return;
+	}
+	case spu_itype::BIZ: branch_indirect_if(op, m_ir->CreateIsNull(get_scalar(op.rt))); return;
+	case spu_itype::BINZ: branch_indirect_if(op, m_ir->CreateIsNotNull(get_scalar(op.rt))); return;
+	case spu_itype::BIHZ: branch_indirect_if(op, m_ir->CreateIsNull(get_scalar(op.rt, 16))); return;
+	case spu_itype::BIHNZ: branch_indirect_if(op, m_ir->CreateIsNotNull(get_scalar(op.rt, 16))); return;
+	case spu_itype::BISL:
+	{
+		// Interrupt flags stored to PC
+		const auto addr = m_ir->CreateAnd(get_scalar(op.ra), 0x3fffc);
+		set_pc(op.d || op.e ? m_ir->CreateOr(addr, op.e << 26 | op.d << 27) : addr);
+		set_link(op.rt);
+		function_call();
+		return;
+	}
+	default:
+	{
+		break;
+	}
+	}
+
+	// Use the interpreter for everything else
+	interpreter_call(op);
+}
+
+spu_llvm_recompiler::spu_llvm_recompiler()
+	: m_jit(std::make_unique<jit_compiler>(std::unordered_map<std::string, u64>
+	{
+		{ "spu_interpreter", (u64)&spu_llvm_interpreter },
+		{ "spu_function_call", (u64)&spu_recompiler_base::function_call },
+		{ "spu_check", (u64)&spu_llvm_check },
+	}, g_cfg.core.llvm_cpu))
+{
+	LOG_SUCCESS(SPU, "SPU Recompiler (LLVM) created...");
+}
+
+spu_llvm_recompiler::~spu_llvm_recompiler()
+{
+}
+
+void spu_llvm_recompiler::compile(spu_function_t& f)
+{
+	compile_all({&f});
+}
+
+void spu_llvm_recompiler::compile_all(const std::vector<spu_function_t*>& funcs)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Functions to compile with their names (address and contents hash)
+	std::vector<std::pair<spu_function_t*, std::string>> list;
+
+	for (spu_function_t* f : funcs)
+	{
+		if (f->compiled.load() || m_failed.count(f))
+		{
+			// skip if function already compiled (or can't be compiled)
+			continue;
+		}
+
+		if (f->addr >= 0x40000 || f->addr % 4 || f->size == 0 || f->size > 0x40000 - f->addr || f->size % 4)
+		{
+			fmt::throw_exception("Invalid SPU function (addr=0x%05x, size=0x%x)" HERE, f->addr, f->size);
+		}
+
+		u8 output[20];
+		sha1(reinterpret_cast<const u8*>(f->data.data()), f->size, output);
+		list.emplace_back(f, fmt::format("spu_%05x_%016llx", f->addr, reinterpret_cast<be_t<u64>&>(output)));
+	}
+
+	if (list.empty())
+	{
+		return;
+	}
+
+	// Object file name in the cache directory: vX-spu-address-hash-cpu.obj (single function) or vX-spu-batch-hash-cpu.obj
+	std::string obj_name;
+
+	if (list.size() == 1)
+	{
+		obj_name = fmt::format("v2-spu-%s-%s.obj", list[0].second.substr(4), m_jit->cpu());
+	}
+	else
+	{
+		sha1_context ctx;
+		u8 output[20];
+
+		sha1_starts(&ctx);
+
+		for (const auto& pair : list)
+		{
+			sha1_update(&ctx, reinterpret_cast<const u8*>(pair.second.c_str()), pair.second.size() + 1);
+		}
+
+		sha1_finish(&ctx, output);
+		obj_name = fmt::format("v2-spu-batch-%016llx-%s.obj", reinterpret_cast<be_t<u64>&>(output), m_jit->cpu());
+	}
+
+	const std::string& cache_path = Emu.GetCachePath();
+
+	// Get compiled functions after finalization (returns false if some are missing)
+	auto install = [&](bool report) -> bool
+	{
+		bool result = true;
+
+		for (const auto& pair : list)
+		{
+			if (const auto compiled = reinterpret_cast<spu_function_t::func_t>(m_jit->get(pair.second)))
+			{
+				pair.first->compiled = compiled;
+			}
+			else
+			{
+				if (report)
+				{
+					LOG_ERROR(SPU, "LLVM: Failed to get compiled function %s", pair.second);
+					m_failed.emplace(pair.first);
+				}
+
+				result = false;
+			}
+		}
+
+		return result;
+	};
+
+	// Check object file
+	if (!cache_path.empty() && fs::is_file(cache_path + obj_name))
+	{
+		m_jit->add(cache_path + obj_name);
+		m_jit->fin();
+
+		if (install(false))
+		{
+			LOG_SUCCESS(SPU, "LLVM: Loaded module %s (%zu functions)", obj_name, list.size());
+			return;
+		}
+
+		LOG_ERROR(SPU, "LLVM: Cached module %s is invalid", obj_name);
+		fs::remove_file(cache_path + obj_name);
+
+		list.erase(std::remove_if(list.begin(), list.end(), [](const auto& pair) { return pair.first->compiled.load() != nullptr; }), list.end());
+	}
+
+	// Create LLVM module (named after the object file for caching), all functions are finalized at once
+	std::unique_ptr<Module> module = std::make_unique<Module>(obj_name, m_jit->get_context());
+	module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
+
+	// Run optimization passes (register allocas must be promoted first)
+	legacy::FunctionPassManager pm(module.get());
+	pm.add(createPromoteMemoryToRegisterPass());
+	pm.add(createCFGSimplificationPass());
+	pm.add(createEarlyCSEPass());
+	pm.add(createInstructionCombiningPass());
+	pm.add(createGVNPass());
+	pm.add(createDeadStoreEliminationPass());
+	pm.add(createAggressiveDCEPass());
+	pm.add(createCFGSimplificationPass());
+
+	std::string log;
+	raw_string_ostream out(log);
+
+	// Don't cache the object file if some functions are missing
+	bool complete = true;
+
+	for (auto it = list.begin(); it != list.end();)
+	{
+		spu_function_t& f = *it->first;
+		const std::string& name = it->second;
+
+		if (module->getFunction(name))
+		{
+			// Identical function already translated
+			++it;
+			continue;
+		}
+
+		// Translate
+		spu_llvm_translator translator(m_jit->get_context(), module.get(), f);
+
+		const auto func = translator.translate(name);
+
+		pm.run(*func);
+
+		if (g_cfg.core.spu_debug)
+		{
+			fmt::append(log, "========== SPU FUNCTION 0x%05x - 0x%05x ==========\n\n", f.addr, f.addr + f.size);
+			out << *func; // print IR
+			out << "\n\n";
+			out.flush();
+			fs::file(Emu.GetCachePath() + "SPULLVM.log", fs::write + fs::append).write(log);
+			log.clear();
+		}
+
+		if (verifyFunction(*func, &out))
+		{
+			// Leave the function uncompiled (it will run in the interpreter)
+			out.flush();
+			LOG_ERROR(SPU, "LLVM: Verification failed for %s:\n%s", name, log);
+			log.clear();
+			func->eraseFromParent();
+			m_failed.emplace(&f);
+			it = list.erase(it);
+			complete = false;
+			continue;
+		}
+
+		++it;
+	}
+
+	if (list.empty())
+	{
+		return;
+	}
+
+	if (verifyModule(*module, &out))
+	{
+		out.flush();
+		LOG_ERROR(SPU, "LLVM: Verification failed for %s:\n%s", obj_name, log);
+
+		for (const auto& pair : list)
+		{
+			m_failed.emplace(pair.first);
+		}
+
+		return;
+	}
+
+	// Generate code (and write the object file)
+	m_jit->add(std::move(module), complete ? cache_path : std::string{});
+	m_jit->fin();
+
+	install(true);
+}
+
+#endif
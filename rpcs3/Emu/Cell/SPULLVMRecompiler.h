@@ -0,0 +1,25 @@
+#pragma once
+
+#include "SPURecompiler.h"
+
+#include <memory>
+
+// SPU LLVM Recompiler (translates whole functions discovered by SPUDatabase)
+class spu_llvm_recompiler : public spu_recompiler_base
+{
+	// JIT instance (shared by all functions compiled by this recompiler)
+	std::unique_ptr<class jit_compiler> m_jit;
+
+	// Functions which failed to compile (executed in the interpreter)
+	std::unordered_set<const spu_function_t*> m_failed;
+
+public:
+	spu_llvm_recompiler();
+
+	~spu_llvm_recompiler() override;
+
+	virtual void compile(spu_function_t& f) override;
+
+	// Compile functions in a single module
+	virtual void compile_all(const std::vector<spu_function_t*>& funcs) override;
+};
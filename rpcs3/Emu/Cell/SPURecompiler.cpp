@@ -1,18 +1,46 @@
 #include "stdafx.h"
 #include "Emu/IdManager.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Crypto/sha1.h"
 
 #include "SPUThread.h"
 #include "SPURecompiler.h"
 #include "SPUASMJITRecompiler.h"
+#include "SPULLVMRecompiler.h"
 #include <algorithm>
 
 extern u64 get_system_time();
 
+const spu_decoder<spu_interpreter_fast> s_spu_interpreter; // Fallback for functions not compiled yet
+const spu_decoder<spu_itype> s_spu_itype;
+
 spu_recompiler_base::~spu_recompiler_base()
 {
 }
 
+void spu_recompiler_base::compile_all(const std::vector<spu_function_t*>& funcs)
+{
+	for (spu_function_t* func : funcs)
+	{
+		compile(*func);
+	}
+}
+
+std::shared_ptr<spu_recompiler_base> spu_recompiler_base::get()
+{
+	if (g_cfg.core.spu_decoder == spu_decoder_type::llvm)
+	{
+#ifdef LLVM_AVAILABLE
+		return fxm::get_always<spu_llvm_recompiler>();
+#else
+		fmt::throw_exception("LLVM is not available in this build." HERE);
+#endif
+	}
+
+	return fxm::get_always<spu_recompiler>();
+}
+
 void spu_recompiler_base::enter(SPUThread& spu)
 {
 	if (spu.pc >= 0x40000 || spu.pc % 4)
@@ -26,11 +54,34 @@ void spu_recompiler_base::enter(SPUThread& spu)
 	// Search if cached data matches
 	auto func = spu.compiled_cache[spu.pc / 4];
 
+	// Verify LS contents only if they could have been modified (raw SPU LS is also writable directly through MMIO)
+	if (func && (spu.offset >= RAW_SPU_BASE_ADDR || !spu.ls_unmodified(func->addr, func->size, spu.compiled_stamp[spu.pc / 4])))
+	{
+		const u64 stamp = spu.ls_stamp;
+
+		if (std::equal(func->data.begin(), func->data.end(), _ls + spu.pc / 4, [](const be_t<u32>& l, const be_t<u32>& r) { return *(u32*)(u8*)&l == *(u32*)(u8*)&r; }))
+		{
+			spu.compiled_stamp[spu.pc / 4] = stamp;
+		}
+		else
+		{
+			func = nullptr;
+		}
+	}
+
 	// Check shared db if we dont have a match
-	if (!func || !std::equal(func->data.begin(), func->data.end(), _ls + spu.pc / 4, [](const be_t<u32>& l, const be_t<u32>& r) { return *(u32*)(u8*)&l == *(u32*)(u8*)&r; }))
+	if (!func)
 	{
+		const u64 stamp = spu.ls_stamp;
+
 		func = spu.spu_db->analyse(_ls, spu.pc);
 		spu.compiled_cache[spu.pc / 4] = func;
+		spu.compiled_stamp[spu.pc / 4] = stamp;
+
+		// Track SPU stores to the function code
+		const u32 first = func->addr >> 12;
+		const u32 last = (func->addr + func->size - 1) >> 12;
+		spu.ls_code_mask |= (~0ull >> (63 - last)) & (~0ull << first);
 	}
 
 	// Reset callstack if necessary
@@ -41,19 +92,52 @@ void spu_recompiler_base::enter(SPUThread& spu)
 	}
 
 	// Compile if needed
-	if (!func->compiled)
+	auto compiled = func->compiled.load();
+
+	if (!compiled)
 	{
 		if (!spu.spu_rec)
 		{
-			spu.spu_rec = fxm::get_always<spu_recompiler>();
+			spu.spu_rec = get();
+		}
+
+		if (spu_precompiler::enabled())
+		{
+			// Request background compilation and don't wait for it
+			fxm::get_always<spu_precompiler>()->add(*func, true);
+		}
+		else
+		{
+			spu.spu_rec->compile(*func);
 		}
 
-		spu.spu_rec->compile(*func);
+		compiled = func->compiled.load();
+
+		if (!compiled)
+		{
+			// Execute current block in the interpreter (not compiled yet, or the compilation failed)
+			while (true)
+			{
+				if (test(spu.state) && spu.check_state())
+				{
+					return;
+				}
+
+				const u32 op = _ls[spu.pc / 4];
+
+				s_spu_interpreter.decode(op)(spu, {op});
+
+				spu.pc += 4;
 
-		if (!func->compiled) fmt::throw_exception("Compilation failed" HERE);
+				if (s_spu_itype.decode(op) & spu_itype::branch)
+				{
+					return;
+				}
+			}
+		}
 	}
 
-	const u32 res = func->compiled(&spu, _ls);
+	const u32 res = compiled(&spu, _ls);
 
 	if (const auto exception = spu.pending_exception)
 	{
@@ -92,3 +176,307 @@ void spu_recompiler_base::enter(SPUThread& spu)
 		spu.srr0 = std::exchange(spu.pc, 0);
 	}
 }
+
+u32 spu_recompiler_base::interpreter_call(SPUThread* _spu, u32 opcode, spu_inter_func_t _func) noexcept
+{
+	try
+	{
+		// TODO: check correctness
+
+		const u32 old_pc = _spu->pc;
+
+		if (test(_spu->state) && _spu->check_state())
+		{
+			return 0x2000000 | _spu->pc;
+		}
+
+		_func(*_spu, { opcode });
+
+		if (old_pc != _spu->pc)
+		{
+			_spu->pc += 4;
+			return 0x2000000 | _spu->pc;
+		}
+
+		_spu->pc += 4;
+		return 0;
+	}
+	catch (...)
+	{
+		_spu->pending_exception = std::current_exception();
+		return 0x1000000 | _spu->pc;
+	}
+}
+
+u32 spu_recompiler_base::function_call(SPUThread* _spu, u32 link) noexcept
+{
+	_spu->recursion_level++;
+
+	try
+	{
+		// TODO: check correctness
+
+		if (_spu->pc & 0x4000000)
+		{
+			if (_spu->pc & 0x8000000)
+			{
+				fmt::throw_exception("Undefined behaviour" HERE);
+			}
+
+			_spu->set_interrupt_status(true);
+			_spu->pc &= ~0x4000000;
+		}
+		else if (_spu->pc & 0x8000000)
+		{
+			_spu->set_interrupt_status(false);
+			_spu->pc &= ~0x8000000;
+		}
+
+		if (_spu->pc == link)
+		{
+			LOG_ERROR(SPU, "Branch-to-next");
+		}
+		else if (_spu->pc == link - 4)
+		{
+			LOG_ERROR(SPU, "Branch-to-self");
+		}
+
+		while (!test(_spu->state) || !_spu->check_state())
+		{
+			// Proceed recursively
+			spu_recompiler_base::enter(*_spu);
+
+			if (test(_spu->state & cpu_flag::ret))
+			{
+				break;
+			}
+
+			if (_spu->pc == link)
+			{
+				_spu->recursion_level--;
+				return 0; // Successfully returned 
+			}
+		}
+
+		_spu->recursion_level--;
+		return 0x2000000 | _spu->pc;
+	}
+	catch (...)
+	{
+		_spu->pending_exception = std::current_exception();
+
+		_spu->recursion_level--;
+		return 0x1000000 | _spu->pc;
+	}
+}
+
+spu_precompiler::spu_precompiler()
+{
+}
+
+void spu_precompiler::on_init(const std::shared_ptr<void>&)
+{
+	// Can't be done in the constructor (fxm is locked)
+	m_db = fxm::get_always<SPUDatabase>();
+	m_rec = spu_recompiler_base::get();
+
+	const u32 count = g_cfg.core.spu_compiler_threads;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		m_workers.emplace_back();
+
+		thread_ctrl::spawn(m_workers.back(), fmt::format("SPU Compiler %u", i), [this, i]()
+		{
+			// Set low priority
+			thread_ctrl::set_native_priority(-1);
+
+			if (i == 0)
+			{
+				// Compile functions cached from the previous runs
+				m_db->precompile(*m_rec);
+			}
+
+			run();
+		});
+	}
+
+	LOG_SUCCESS(SPU, "SPU background compiler started (%u threads)", count);
+}
+
+spu_precompiler::~spu_precompiler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_cv.notify_all();
+
+	for (auto& thread : m_workers)
+	{
+		thread->join();
+	}
+}
+
+bool spu_precompiler::enabled()
+{
+	return g_cfg.core.spu_compiler_threads > 0 && (g_cfg.core.spu_decoder == spu_decoder_type::asmjit || g_cfg.core.spu_decoder == spu_decoder_type::llvm);
+}
+
+void spu_precompiler::add(std::vector<be_t<u32>> ls, u32 entry)
+{
+	if (ls.size() != 0x10000 || entry >= 0x40000 || entry % 4)
+	{
+		LOG_ERROR(SPU, "SPU background compiler: invalid image (entry=0x%x)", entry);
+		return;
+	}
+
+	// Hash LS contents to skip images analysed before
+	u8 output[20];
+	sha1(reinterpret_cast<const u8*>(ls.data()), 0x40000, output);
+	const u64 hash = reinterpret_cast<be_t<u64>&>(output) + u64{entry};
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_hashes.emplace(hash).second)
+		{
+			return;
+		}
+
+		m_images.emplace_back(std::move(ls), entry);
+	}
+
+	m_cv.notify_one();
+}
+
+void spu_precompiler::add(spu_function_t& func, bool urgent)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto found = m_queued.find(&func);
+
+		if (found != m_queued.end() && (found->second || !urgent))
+		{
+			return;
+		}
+
+		if (urgent)
+		{
+			// Move it in front of the functions found by analysis
+			m_funcs.emplace_front(&func);
+		}
+		else
+		{
+			m_funcs.emplace_back(&func);
+		}
+
+		m_queued[&func] = urgent;
+	}
+
+	m_cv.notify_one();
+}
+
+void spu_precompiler::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		if (!m_funcs.empty())
+		{
+			// Take an urgent function alone (to compile it as soon as possible), or a batch of functions found by analysis
+			std::vector<spu_function_t*> batch;
+
+			auto urgent = [&](spu_function_t* func)
+			{
+				const auto found = m_queued.find(func);
+				return found != m_queued.end() && found->second;
+			};
+
+			do
+			{
+				if (!m_funcs.front()->compiled.load())
+				{
+					batch.emplace_back(m_funcs.front());
+				}
+
+				m_funcs.pop_front();
+			}
+			while (!m_funcs.empty() && batch.size() < spu_recompiler_base::batch_max && (batch.empty() || !urgent(batch[0])) && !urgent(m_funcs.front()));
+
+			lock.unlock();
+
+			try
+			{
+				m_rec->compile_all(batch);
+			}
+			catch (const std::exception& e)
+			{
+				LOG_ERROR(SPU, "SPU background compiler: failed to compile %zu function(s) at 0x%05x: %s", batch.size(), batch[0]->addr, e.what());
+			}
+
+			lock.lock();
+
+			for (spu_function_t* func : batch)
+			{
+				if (!func->compiled.load())
+				{
+					// Allow the function to be queued again
+					m_queued.erase(func);
+				}
+			}
+
+			continue;
+		}
+
+		if (!m_images.empty())
+		{
+			const auto image = std::move(m_images.front());
+			m_images.pop_front();
+			lock.unlock();
+
+			analyse(image.first, image.second);
+
+			lock.lock();
+			continue;
+		}
+
+		m_cv.wait(lock);
+	}
+}
+
+void spu_precompiler::analyse(const std::vector<be_t<u32>>& ls, u32 entry)
+{
+	// Plausible function entry points (starting from the image entry point)
+	std::vector<u32> entries{entry};
+	std::unordered_set<u32> visited{entry};
+
+	while (!entries.empty() && visited.size() < 0x10000 && !m_stop && !Emu.IsStopped())
+	{
+		const u32 addr = entries.back();
+		entries.pop_back();
+
+		const auto func = m_db->analyse(ls.data(), addr);
+
+		if (!func)
+		{
+			continue;
+		}
+
+		add(*func, false);
+
+		// Follow branches to other functions
+		for (u32 target : func->adjacent)
+		{
+			if (target < 0x40000 && target % 4 == 0 && visited.emplace(target).second)
+			{
+				entries.emplace_back(target);
+			}
+		}
+	}
+
+	LOG_NOTICE(SPU, "SPU background compiler: image analysed (entry=0x%05x, %u entries)", entry, visited.size());
+}
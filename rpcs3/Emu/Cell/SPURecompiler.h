@@ -1,8 +1,14 @@
 #pragma once
 
 #include "SPUAnalyser.h"
+#include "SPUInterpreter.h"
 
 #include <mutex>
+#include <memory>
+#include <deque>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
 
 // SPU Recompiler instance base (must be global or PS3 process-local)
 class spu_recompiler_base
@@ -20,6 +26,70 @@ public:
 	// Compile specified function
 	virtual void compile(spu_function_t& f) = 0;
 
+	// Max number of functions passed to compile_all() at once
+	static const u32 batch_max = 64;
+
+	// Compile specified functions (may be compiled together)
+	virtual void compile_all(const std::vector<spu_function_t*>& funcs);
+
+	// Get recompiler instance selected in the settings
+	static std::shared_ptr<spu_recompiler_base> get();
+
 	// Run
 	static void enter(class SPUThread&);
+
+	// Execute single instruction in the interpreter (returns 0 to continue, or new PC with flags to return)
+	static u32 interpreter_call(SPUThread* _spu, u32 opcode, spu_inter_func_t _func) noexcept;
+
+	// Call the function at _spu->pc recursively (returns 0 if it returned to the link address, or new PC with flags to return)
+	static u32 function_call(SPUThread* _spu, u32 link) noexcept;
+};
+
+// SPU background compiler (global): analyses SPU images and compiles functions at low priority
+class spu_precompiler final
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	// Functions waiting for compilation (urgent ones are in front, owned by m_db)
+	std::deque<spu_function_t*> m_funcs;
+
+	// LS images waiting for analysis (full copy and entry point)
+	std::deque<std::pair<std::vector<be_t<u32>>, u32>> m_images;
+
+	// Queued functions (value is true if it was requested by an SPU thread)
+	std::unordered_map<spu_function_t*, bool> m_queued;
+
+	// Hashes of the analysed images
+	std::unordered_set<u64> m_hashes;
+
+	std::shared_ptr<SPUDatabase> m_db;
+	std::shared_ptr<spu_recompiler_base> m_rec;
+
+	std::vector<std::shared_ptr<class thread_ctrl>> m_workers;
+
+	// Set on destruction (also checked by analyse() without the lock)
+	atomic_t<bool> m_stop{false};
+
+	// Worker thread entry point
+	void run();
+
+	// Analyse LS image and queue all detected functions
+	void analyse(const std::vector<be_t<u32>>& ls, u32 entry);
+
+public:
+	spu_precompiler();
+	~spu_precompiler();
+
+	// Start worker threads
+	void on_init(const std::shared_ptr<void>&);
+
+	// Check whether background compilation is enabled in the settings
+	static bool enabled();
+
+	// Queue LS image (full 256 KiB copy) for analysis starting from the entry point
+	void add(std::vector<be_t<u32>> ls, u32 entry);
+
+	// Queue function for compilation (urgent: requested by an SPU thread)
+	void add(spu_function_t& func, bool urgent);
 };
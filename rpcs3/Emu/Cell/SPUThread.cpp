@@ -314,9 +314,22 @@ void SPUThread::cpu_task()
 {
 	std::fesetround(FE_TOWARDZERO);
 	
-	if (g_cfg.core.spu_decoder == spu_decoder_type::asmjit)
+	if (g_cfg.core.spu_decoder == spu_decoder_type::asmjit || g_cfg.core.spu_decoder == spu_decoder_type::llvm)
 	{
 		if (!spu_db) spu_db = fxm::get_always<SPUDatabase>();
+		if (!spu_rec) spu_rec = spu_recompiler_base::get();
+
+		if (spu_precompiler::enabled())
+		{
+			// Compile functions cached from the previous runs in background
+			fxm::get_always<spu_precompiler>();
+		}
+		else
+		{
+			// Compile functions cached from the previous runs
+			spu_db->precompile(*spu_rec);
+		}
+
 		return spu_recompiler_base::enter(*this);
 	}
 
@@ -402,6 +415,9 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 	u32 eal = args.eal;
 	u32 lsa = args.lsa & 0x3ffff;
 
+	// SPU thread whose LS is written by DMA PUT (SPU Thread Group MMIO)
+	SPUThread* target = nullptr;
+
 	if (eal >= SYS_SPU_THREAD_BASE_LOW && offset < RAW_SPU_BASE_ADDR) // SPU Thread Group MMIO (LS and SNR)
 	{
 		const u32 index = (eal - SYS_SPU_THREAD_BASE_LOW) / SYS_SPU_THREAD_OFFSET; // thread number in group
@@ -414,6 +430,7 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 			if (offset + args.size - 1 < 0x40000) // LS access
 			{
 				eal = spu.offset + offset; // redirect access
+				target = &spu;
 			}
 			else if (!is_get && args.size == 4 && (offset == SYS_SPU_THREAD_SNR1 || offset == SYS_SPU_THREAD_SNR2))
 			{
@@ -441,6 +458,15 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 		std::swap(dst, src);
 	}
 
+	// Without TSX, PUT locks the lock lines it covers to exclude PUTLLC and PUTLLUC (they only lock their own lock line)
+	const u32 lock_first = eal & ~127u;
+	const u32 lock_count = !is_get && !s_use_rtm && args.size ? (eal + args.size - 1) / 128 - lock_first / 128 + 1 : 0;
+
+	for (u32 i = 0, addr = lock_first; i < lock_count; i++, addr += 128)
+	{
+		vm::reservation_lock(addr, 128);
+	}
+
 	switch (u32 size = args.size)
 	{
 	case 1:
@@ -559,6 +585,43 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 	{
 		//_mm_sfence();
 	}
+
+	if (lock_count)
+	{
+		// Order non-temporal stores before unlocking
+		_mm_sfence();
+	}
+
+	for (u32 i = 0, addr = lock_first; i < lock_count; i++, addr += 128)
+	{
+		// Restore the timestamp (plain DMA doesn't update reservations)
+		vm::reservation_unlock(addr, vm::reservation_acquire(addr, 128) & ~1ull);
+	}
+
+	// Invalidate compiled code (after the data is written)
+	if (is_get)
+	{
+		ls_modified(lsa, args.size);
+	}
+	else if (target)
+	{
+		target->ls_modified(eal - target->offset, args.size);
+	}
+}
+
+void SPUThread::ls_modified(u32 lsa, u32 size)
+{
+	if (!size)
+	{
+		return;
+	}
+
+	const u64 stamp = ++ls_stamp;
+
+	for (u32 i = lsa >> 12, end = std::min<u32>((lsa + size - 1) >> 12, 63); i <= end; i++)
+	{
+		ls_page_stamp[i] = stamp;
+	}
 }
 
 void SPUThread::process_mfc_cmd()
@@ -592,7 +655,7 @@ void SPUThread::process_mfc_cmd()
 		auto& data = vm::ps3::_ref<decltype(rdata)>(ch_mfc_cmd.eal);
 
 		const u32 _addr = ch_mfc_cmd.eal;
-		const u64 _time = vm::reservation_acquire(raddr, 128);
+		const u64 _time = vm::reservation_wait(_addr, 128);
 
 		if (raddr && raddr != ch_mfc_cmd.eal)
 		{
@@ -633,10 +696,18 @@ void SPUThread::process_mfc_cmd()
 			}
 
 			rtime = vm::reservation_acquire(raddr, 128);
+
+			if (rtime & 1)
+			{
+				// The lock line is being updated
+				_xabort(0);
+			}
+
 			rdata = data;
 			_xend();
 
 			_ref<decltype(rdata)>(ch_mfc_cmd.lsa & 0x3ffff) = rdata;
+			ls_store(ch_mfc_cmd.lsa & 0x3ff80);
 			return ch_atomic_stat.set_value(MFC_GETLLAR_SUCCESS);
 		}
 		else
@@ -649,13 +720,20 @@ void SPUThread::process_mfc_cmd()
 		if (is_polling || UNLIKELY(vm::reservation_acquire(raddr, 128) != rtime))
 		{
 			// TODO: vm::check_addr
-			vm::reader_lock lock;
-			rtime = vm::reservation_acquire(raddr, 128);
-			rdata = data;
+			do
+			{
+				// Wait for the lock line to be unlocked and read again
+				rtime = vm::reservation_wait(raddr, 128);
+				_mm_lfence();
+				rdata = data;
+				_mm_lfence();
+			}
+			while (UNLIKELY(vm::reservation_acquire(raddr, 128) != rtime));
 		}
 
 		// Copy to LS
 		_ref<decltype(rdata)>(ch_mfc_cmd.lsa & 0x3ffff) = rdata;
+		ls_store(ch_mfc_cmd.lsa & 0x3ff80);
 
 		return ch_atomic_stat.set_value(MFC_GETLLAR_SUCCESS);
 	}
@@ -684,23 +762,29 @@ void SPUThread::process_mfc_cmd()
 					result = true;
 
 					vm::reservation_update(raddr, 128);
-					vm::notify(raddr, 128);
 				}
 
 				_xend();
 			}
-			else
+			else if (vm::reservation_trylock(raddr, rtime))
 			{
-				vm::writer_lock lock;
-
-				if (rtime == vm::reservation_acquire(raddr, 128) && rdata == data)
+				// Only this lock line is locked (the timestamp was unchanged)
+				if (rdata == data)
 				{
 					data = to_write;
 					result = true;
 
 					vm::reservation_update(raddr, 128);
-					vm::notify(raddr, 128);
 				}
+				else
+				{
+					vm::reservation_unlock(raddr, rtime);
+				}
+			}
+
+			if (result)
+			{
+				vm::notify(raddr, 128);
 			}
 		}
 
@@ -744,16 +828,22 @@ void SPUThread::process_mfc_cmd()
 				_xabort(0);
 			}
 
+			if (vm::reservation_acquire(ch_mfc_cmd.eal, 128) & 1)
+			{
+				// The lock line is being updated
+				_xabort(0);
+			}
+
 			data = to_write;
 			vm::reservation_update(ch_mfc_cmd.eal, 128);
-			vm::notify(ch_mfc_cmd.eal, 128);
 			_xend();
 
+			vm::notify(ch_mfc_cmd.eal, 128);
 			ch_atomic_stat.set_value(MFC_PUTLLUC_SUCCESS);
 			return;
 		}
 
-		vm::writer_lock lock(0);
+		vm::reservation_lock(ch_mfc_cmd.eal, 128);
 		data = to_write;
 		vm::reservation_update(ch_mfc_cmd.eal, 128);
 		vm::notify(ch_mfc_cmd.eal, 128);
@@ -919,7 +1009,7 @@ void SPUThread::process_mfc_cmd()
 u32 SPUThread::get_events(bool waiting)
 {
 	// Check reservation status and set SPU_EVENT_LR if lost
-	if (raddr && (vm::reservation_acquire(raddr, sizeof(rdata)) != rtime || rdata != vm::ps3::_ref<decltype(rdata)>(raddr)))
+	if (raddr && ((vm::reservation_acquire(raddr, sizeof(rdata)) & ~1ull) != rtime || rdata != vm::ps3::_ref<decltype(rdata)>(raddr)))
 	{
 		ch_event_stat |= SPU_EVENT_LR;
 		raddr = 0;
@@ -585,10 +585,43 @@ public:
 	std::exception_ptr pending_exception;
 
 	std::array<struct spu_function_t*, 65536> compiled_cache{};
+	std::array<u64, 65536> compiled_stamp{}; // Value of ls_stamp when compiled_cache entry was verified
+
+	// LS modification tracking (4 KiB pages) used to avoid verifying compiled_cache entries
+	std::array<u64, 64> ls_page_stamp{}; // Stamps of the last writes
+	atomic_t<u64> ls_stamp{1}; // Write counter
+	u64 ls_code_mask = 0; // Pages containing code of verified compiled_cache entries (SPU stores check it)
+
 	std::shared_ptr<class SPUDatabase> spu_db;
 	std::shared_ptr<class spu_recompiler_base> spu_rec;
 	u32 recursion_level = 0;
 
+	// Mark LS range as modified (may be called from another thread)
+	void ls_modified(u32 lsa, u32 size);
+
+	// Check LS write by an SPU store instruction (address must be masked)
+	void ls_store(u32 lsa)
+	{
+		if (UNLIKELY(ls_code_mask >> (lsa >> 12) & 1))
+		{
+			ls_modified(lsa, 16);
+		}
+	}
+
+	// Check whether LS range wasn't modified since the specified stamp
+	bool ls_unmodified(u32 lsa, u32 size, u64 stamp) const
+	{
+		for (u32 i = lsa >> 12, end = (lsa + size - 1) >> 12; i <= end; i++)
+		{
+			if (ls_page_stamp[i] > stamp)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	void push_snr(u32 number, u32 value);
 	void do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc = true);
 
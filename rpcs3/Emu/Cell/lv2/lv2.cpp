@@ -1011,6 +1011,379 @@ DECLARE(lv2_obj::g_mutex);
 DECLARE(lv2_obj::g_ppu);
 DECLARE(lv2_obj::g_pending);
 DECLARE(lv2_obj::g_waiting);
+DECLARE(lv2_obj::g_timer);
+
+u32 lv2_ppu_queue::find(u32 prio) const
+{
+	if (prio >= prio_count)
+	{
+		return prio_count;
+	}
+
+	// Check the remaining bits of the word
+	if (const u64 bits = m_bits[prio / 64] & (~0ull << (prio % 64)))
+	{
+		return (prio & ~63) + ::cnttz64(bits, true);
+	}
+
+	// Find next non-empty word
+	const u32 word = prio / 64 + 1;
+
+	if (word >= prio_count / 64)
+	{
+		return prio_count;
+	}
+
+	if (const u64 mask = m_mask & (~0ull << word))
+	{
+		const u32 found = ::cnttz64(mask, true);
+		return found * 64 + ::cnttz64(m_bits[found], true);
+	}
+
+	return prio_count;
+}
+
+bool lv2_ppu_queue::contains(const ppu_thread* ppu) const
+{
+	return ppu->sched_prio < prio_count;
+}
+
+void lv2_ppu_queue::push(ppu_thread* ppu)
+{
+	const u32 prio = std::min<u32>(ppu->prio, prio_count - 1);
+
+	ppu->sched_prio = prio;
+	ppu->sched_next = nullptr;
+	ppu->sched_prev = m_tail[prio];
+
+	if (m_tail[prio])
+	{
+		m_tail[prio]->sched_next = ppu;
+	}
+	else
+	{
+		m_head[prio] = ppu;
+		m_bits[prio / 64] |= 1ull << (prio % 64);
+		m_mask |= 1ull << (prio / 64);
+	}
+
+	m_tail[prio] = ppu;
+	m_size++;
+}
+
+bool lv2_ppu_queue::remove(ppu_thread* ppu)
+{
+	const u32 prio = ppu->sched_prio;
+
+	if (prio >= prio_count)
+	{
+		return false;
+	}
+
+	(ppu->sched_prev ? ppu->sched_prev->sched_next : m_head[prio]) = ppu->sched_next;
+	(ppu->sched_next ? ppu->sched_next->sched_prev : m_tail[prio]) = ppu->sched_prev;
+
+	if (!m_head[prio])
+	{
+		m_bits[prio / 64] &= ~(1ull << (prio % 64));
+
+		if (!m_bits[prio / 64])
+		{
+			m_mask &= ~(1ull << (prio / 64));
+		}
+	}
+
+	ppu->sched_prio = -1;
+	ppu->sched_prev = nullptr;
+	ppu->sched_next = nullptr;
+	m_size--;
+	return true;
+}
+
+ppu_thread* lv2_ppu_queue::front() const
+{
+	const u32 prio = find(0);
+	return prio < prio_count ? m_head[prio] : nullptr;
+}
+
+ppu_thread* lv2_ppu_queue::next(const ppu_thread* ppu) const
+{
+	if (ppu->sched_next)
+	{
+		return ppu->sched_next;
+	}
+
+	const u32 prio = find(ppu->sched_prio + 1);
+	return prio < prio_count ? m_head[prio] : nullptr;
+}
+
+void lv2_ppu_queue::clear()
+{
+	// Threads are not accessed (they may be already destroyed)
+	m_head.fill(nullptr);
+	m_tail.fill(nullptr);
+	m_bits.fill(0);
+	m_mask = 0;
+	m_size = 0;
+}
+
+// Find first non-empty slot starting from the position (returns slot count if not found)
+static u32 find_slot(const std::array<u64, 4>& bits, u32 pos)
+{
+	for (u32 i = pos / 64; i < bits.size(); i++)
+	{
+		if (const u64 mask = i == pos / 64 ? bits[i] & (~0ull << (pos % 64)) : bits[i])
+		{
+			return i * 64 + ::cnttz64(mask, true);
+		}
+	}
+
+	return 256;
+}
+
+lv2_timer_service::~lv2_timer_service()
+{
+	clear();
+}
+
+u64 lv2_timer_service::add(u64 when, callback func)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_funcs.empty())
+	{
+		// Drop cancelled handles and move the wheel to the current time
+		for (auto& _lv : m_wheel)
+		{
+			for (auto& slot : _lv.slots)
+			{
+				slot.clear();
+			}
+
+			_lv.bits.fill(0);
+		}
+
+		m_time = std::max(m_time, get_system_time());
+	}
+
+	if (!m_thread)
+	{
+		m_stop = false;
+		thread_ctrl::spawn(m_thread, "lv2 Timer Thread", [this]() { run(); });
+	}
+
+	const u64 handle = ++m_last_handle;
+	m_funcs.emplace(handle, std::make_pair(when, std::move(func)));
+	insert(handle, when);
+
+	if (when < m_wakeup)
+	{
+		m_cv.notify_one();
+	}
+
+	return handle;
+}
+
+bool lv2_timer_service::cancel(u64 handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_funcs.erase(handle) != 0;
+}
+
+void lv2_timer_service::clear()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+		m_cv.notify_one();
+	}
+
+	if (m_thread)
+	{
+		m_thread->join();
+		m_thread.reset();
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_funcs.clear();
+}
+
+void lv2_timer_service::run()
+{
+	thread_ctrl::set_native_priority(1);
+
+	std::vector<callback> ready;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		const u64 now = get_system_time();
+
+		advance(now, ready);
+
+		if (!ready.empty())
+		{
+			// Callbacks are called unlocked (they may use the scheduler or register new callbacks)
+			m_wakeup = 0;
+			lock.unlock();
+
+			for (auto& func : ready)
+			{
+				func();
+			}
+
+			ready.clear();
+			lock.lock();
+			continue;
+		}
+
+		m_wakeup = m_funcs.empty() ? UINT64_MAX : next();
+
+		// Time before the deadline when the thread stops sleeping and starts spinning
+		const u64 spin_time = g_cfg.core.lv2_timer_spin;
+
+		if (m_wakeup == UINT64_MAX)
+		{
+			m_cv.wait(lock);
+		}
+		else if (m_wakeup > now + spin_time)
+		{
+			m_cv.wait_for(lock, std::chrono::microseconds(m_wakeup - now - spin_time));
+		}
+		else if (m_wakeup > now)
+		{
+			// Spin until the deadline (host sleep is too imprecise)
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+		}
+	}
+
+	m_wakeup = UINT64_MAX;
+}
+
+void lv2_timer_service::insert(u64 handle, u64 when)
+{
+	// Expired callbacks are put into the current slot
+	const u64 delta = when > m_time ? when - m_time : 0;
+
+	u32 lv = 0;
+	u32 pos;
+
+	if (delta >> (slot_bits * level_count))
+	{
+		// Out of range: put into the last slot of the top level (will be reinserted on cascade)
+		lv = level_count - 1;
+		pos = ((m_time >> (slot_bits * lv)) + slot_count - 1) % slot_count;
+	}
+	else
+	{
+		while (delta >> (slot_bits * (lv + 1)))
+		{
+			lv++;
+		}
+
+		pos = ((m_time + delta) >> (slot_bits * lv)) % slot_count;
+	}
+
+	auto& _lv = m_wheel[lv];
+	_lv.slots[pos].emplace_back(handle);
+	_lv.bits[pos / 64] |= 1ull << (pos % 64);
+}
+
+u64 lv2_timer_service::next() const
+{
+	u64 result = UINT64_MAX;
+
+	for (u32 lv = 0; lv < level_count; lv++)
+	{
+		const u32 shift = slot_bits * lv;
+		const u64 base = m_time >> (shift + slot_bits) << (shift + slot_bits);
+
+		// The current slot of the upper levels is already cascaded (it belongs to the next round)
+		const u32 cur = (m_time >> shift) % slot_count;
+		const auto& bits = m_wheel[lv].bits;
+
+		const u32 pos = find_slot(bits, lv ? cur + 1 : cur);
+		const u32 wrap = find_slot(bits, 0);
+
+		if (pos < slot_count)
+		{
+			result = std::min(result, base + (u64{pos} << shift));
+		}
+		else if (wrap < slot_count)
+		{
+			// Next round
+			result = std::min(result, base + (u64{slot_count + wrap} << shift));
+		}
+	}
+
+	return result;
+}
+
+void lv2_timer_service::advance(u64 now, std::vector<callback>& out)
+{
+	std::vector<u64> handles;
+
+	// Take all handles from the slot
+	auto take = [&](level& _lv, u32 pos)
+	{
+		handles.clear();
+
+		if (_lv.bits[pos / 64] & (1ull << (pos % 64)))
+		{
+			handles.swap(_lv.slots[pos]);
+			_lv.bits[pos / 64] &= ~(1ull << (pos % 64));
+		}
+	};
+
+	while (m_time <= now)
+	{
+		if (m_time % slot_count == 0)
+		{
+			// Cascade upper levels (next level only if the current one has wrapped around)
+			for (u32 lv = 1; lv < level_count; lv++)
+			{
+				const u32 pos = (m_time >> (slot_bits * lv)) % slot_count;
+
+				take(m_wheel[lv], pos);
+
+				for (u64 handle : handles)
+				{
+					const auto found = m_funcs.find(handle);
+
+					if (found != m_funcs.end())
+					{
+						insert(handle, found->second.first);
+					}
+				}
+
+				if (pos)
+				{
+					break;
+				}
+			}
+		}
+
+		take(m_wheel[0], m_time % slot_count);
+
+		for (u64 handle : handles)
+		{
+			const auto found = m_funcs.find(handle);
+
+			if (found != m_funcs.end())
+			{
+				out.emplace_back(std::move(found->second.second));
+				m_funcs.erase(found);
+			}
+		}
+
+		// Skip empty slots
+		m_time = std::min(next(), now + 1);
+	}
+}
 
 void lv2_obj::sleep_timeout(named_thread& thread, u64 timeout)
 {
@@ -1037,7 +1410,7 @@ void lv2_obj::sleep_timeout(named_thread& thread, u64 timeout)
 		}
 
 		// Find and remove the thread
-		unqueue(g_ppu, ppu);
+		g_ppu.remove(ppu);
 		unqueue(g_pending, ppu);
 
 		ppu->start_time = start_time;
@@ -1045,19 +1418,24 @@ void lv2_obj::sleep_timeout(named_thread& thread, u64 timeout)
 
 	if (timeout)
 	{
-		const u64 wait_until = start_time + timeout;
-
-		// Register timeout if necessary
-		for (auto it = g_waiting.begin(), end = g_waiting.end(); it != end; it++)
+		// Register timeout (replaces the previous one)
+		// The callback may still run after cancel() fails, when the thread can already be gone
+		const u64 handle = g_timer.add(start_time + timeout, [ctrl = thread.get_weak()]()
 		{
-			if (it->first > wait_until)
+			if (const auto ptr = ctrl.lock())
 			{
-				g_waiting.emplace(it, wait_until, &thread);
-				return;
+				ptr->notify();
 			}
+		});
+
+		auto& old = g_waiting[&thread];
+
+		if (old)
+		{
+			g_timer.cancel(old);
 		}
 
-		g_waiting.emplace_back(wait_until, &thread);
+		old = handle;
 	}
 
 	schedule_all();
@@ -1070,62 +1448,54 @@ void lv2_obj::awake(cpu_thread& cpu, u32 prio)
 
 	semaphore_lock lock(g_mutex);
 
+	const auto ppu = &static_cast<ppu_thread&>(cpu);
+
 	if (prio == -4)
 	{
 		// Yield command
 		const u64 start_time = get_system_time();
 
-		for (std::size_t i = 0, pos = -1; i < g_ppu.size(); i++)
+		if (g_ppu.contains(ppu))
 		{
-			if (g_ppu[i] == &cpu)
-			{
-				pos = i;
-				prio = g_ppu[i]->prio;
-			}
-			else if (i == pos + 1 && prio != -4 && g_ppu[i]->prio != prio)
+			const auto next = g_ppu.next(ppu);
+
+			if (next && next->sched_prio != ppu->sched_prio)
 			{
+				// No other threads with the same priority
 				return;
 			}
 		}
 
-		unqueue(g_ppu, &cpu);
+		g_ppu.remove(ppu);
 		unqueue(g_pending, &cpu);
 
-		static_cast<ppu_thread&>(cpu).start_time = start_time;
+		ppu->start_time = start_time;
 	}
 
-	if (prio < INT32_MAX && !unqueue(g_ppu, &cpu))
+	if (prio < INT32_MAX && !g_ppu.remove(ppu))
 	{
 		// Priority set
 		return;
 	}
 
 	// Emplace current thread
-	for (std::size_t i = 0; i <= g_ppu.size(); i++)
+	if (g_ppu.contains(ppu))
+	{
+		LOG_TRACE(PPU, "sleep() - suspended (p=%zu)", g_pending.size());
+	}
+	else
 	{
-		if (i < g_ppu.size() && g_ppu[i] == &cpu)
-		{
-			LOG_TRACE(PPU, "sleep() - suspended (p=%zu)", g_pending.size());
-			break;
-		}
-
 		// Use priority, also preserve FIFO order
-		if (i == g_ppu.size() || g_ppu[i]->prio > static_cast<ppu_thread&>(cpu).prio)
-		{
-			LOG_TRACE(PPU, "awake(): %s", cpu.id);
-			g_ppu.insert(g_ppu.cbegin() + i, &static_cast<ppu_thread&>(cpu));
+		LOG_TRACE(PPU, "awake(): %s", cpu.id);
+		g_ppu.push(ppu);
 
-			// Unregister timeout if necessary
-			for (auto it = g_waiting.cbegin(), end = g_waiting.cend(); it != end; it++)
-			{
-				if (it->second == &cpu)
-				{
-					g_waiting.erase(it);
-					break;
-				}
-			}
+		// Unregister timeout if necessary
+		const auto found = g_waiting.find(&cpu);
 
-			break;
+		if (found != g_waiting.end())
+		{
+			g_timer.cancel(found->second);
+			g_waiting.erase(found);
 		}
 	}
 
@@ -1135,16 +1505,34 @@ void lv2_obj::awake(cpu_thread& cpu, u32 prio)
 		unqueue(g_pending, &cpu);
 	}
 
-	// Suspend threads if necessary
-	for (std::size_t i = g_cfg.core.ppu_threads; i < g_ppu.size(); i++)
+	// Suspend threads if necessary (threads after the first ppu_threads are already suspended,
+	// so only the thread shifted to the boundary and the inserted thread itself need to be checked)
+	auto suspend = [](ppu_thread* target)
 	{
-		const auto target = g_ppu[i];
-
 		if (!target->state.test_and_set(cpu_flag::suspend))
 		{
 			LOG_TRACE(PPU, "suspend(): %s", target->id);
 			g_pending.emplace_back(target);
 		}
+	};
+
+	bool is_running = false;
+	ppu_thread* target = g_ppu.front();
+
+	for (u32 i = 0; target && i < g_cfg.core.ppu_threads; i++)
+	{
+		is_running = is_running || target == ppu;
+		target = g_ppu.next(target);
+	}
+
+	if (target)
+	{
+		suspend(target);
+	}
+
+	if (!is_running && g_ppu.contains(ppu))
+	{
+		suspend(ppu);
 	}
 
 	schedule_all();
@@ -1152,6 +1540,8 @@ void lv2_obj::awake(cpu_thread& cpu, u32 prio)
 
 void lv2_obj::cleanup()
 {
+	// Stop the timer thread first (callbacks may access the scheduler)
+	g_timer.clear();
 	g_ppu.clear();
 	g_pending.clear();
 	g_waiting.clear();
@@ -1162,10 +1552,10 @@ void lv2_obj::schedule_all()
 	if (g_pending.empty())
 	{
 		// Wake up threads
-		for (std::size_t i = 0, x = std::min<std::size_t>(g_cfg.core.ppu_threads, g_ppu.size()); i < x; i++)
-		{
-			const auto target = g_ppu[i];
+		auto target = g_ppu.front();
 
+		for (u32 i = 0; target && i < g_cfg.core.ppu_threads; i++, target = g_ppu.next(target))
+		{
 			if (test(target->state, cpu_flag::suspend))
 			{
 				LOG_TRACE(PPU, "schedule(): %s", target->id);
@@ -1179,23 +1569,6 @@ void lv2_obj::schedule_all()
 			}
 		}
 	}
-
-	// Check registered timeouts
-	while (!g_waiting.empty())
-	{
-		auto& pair = g_waiting.front();
-
-		if (pair.first <= get_system_time())
-		{
-			pair.second->notify();
-			g_waiting.pop_front();
-		}
-		else
-		{
-			// The list is sorted so assume no more timeouts
-			break;
-		}
-	}
 }
 
 void ppu_thread::cpu_sleep()
@@ -243,6 +243,7 @@ s32 sys_rsx_context_attribute(s32 context_id, u32 package_id, u64 a3, u64 a4, u6
 		render->ctrl->get = a3;
 		render->ctrl->put = a4;
 		render->internal_get = a3;
+		render->fifo_reset = u64{1} << 32 | a3;
 		break;
 
 	case 0x100: // Display mode set
@@ -11,6 +11,7 @@
 #include "Emu/Cell/ErrorCodes.h"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/RawSPUThread.h"
+#include "Emu/Cell/SPURecompiler.h"
 #include "sys_interrupt.h"
 #include "sys_event.h"
 #include "sys_spu.h"
@@ -61,6 +62,8 @@ void sys_spu_image::load(const fs::file& stream)
 	}
 
 	vm::page_protect(segs.addr(), ::align(mem_size, 4096), 0, 0, vm::page_writable);
+
+	precompile(segs.get_ptr(), nsegs, entry_point);
 }
 
 void sys_spu_image::free()
@@ -139,6 +142,38 @@ void sys_spu_image::deploy(u32 loc, sys_spu_segment* segs, u32 nsegs)
 	LOG_NOTICE(LOADER, "Loaded SPU image: %s (<- %u)%s", hash, applied, dump);
 }
 
+void sys_spu_image::precompile(const sys_spu_segment* segs, u32 nsegs, u32 entry)
+{
+	if (!spu_precompiler::enabled())
+	{
+		return;
+	}
+
+	// Build LS image
+	std::vector<be_t<u32>> ls(0x10000);
+
+	for (u32 i = 0; i < nsegs; i++)
+	{
+		const auto& seg = segs[i];
+
+		if (seg.ls >= 0x40000 || seg.size > 0x40000 - seg.ls || (seg.ls | seg.size) % 4)
+		{
+			continue;
+		}
+
+		if (seg.type == SYS_SPU_SEGMENT_TYPE_COPY)
+		{
+			std::memcpy(ls.data() + seg.ls / 4, vm::base(seg.addr), seg.size);
+		}
+		else if (seg.type == SYS_SPU_SEGMENT_TYPE_FILL)
+		{
+			std::fill_n(reinterpret_cast<u32*>(ls.data() + seg.ls / 4), seg.size / 4, seg.addr);
+		}
+	}
+
+	fxm::get_always<spu_precompiler>()->add(std::move(ls), entry);
+}
+
 error_code sys_spu_initialize(u32 max_usable_spu, u32 max_raw_spu)
 {
 	sys_spu.warning("sys_spu_initialize(max_usable_spu=%d, max_raw_spu=%d)", max_usable_spu, max_raw_spu);
@@ -244,6 +279,12 @@ error_code sys_spu_thread_initialize(vm::ptr<u32> thread, u32 group_id, u32 spu_
 	group->imgs[spu_num] = std::make_pair(*img, std::vector<sys_spu_segment>());
 	group->imgs[spu_num].second.assign(img->segs.get_ptr(), img->segs.get_ptr() + img->nsegs);
 
+	if (img->type == SYS_SPU_IMAGE_TYPE_USER)
+	{
+		// Kernel images are analysed on load
+		sys_spu_image::precompile(group->imgs[spu_num].second.data(), img->nsegs, img->entry_point);
+	}
+
 	if (++group->init == group->num)
 	{
 		group->run_state = SPU_THREAD_GROUP_STATUS_INITIALIZED;
@@ -385,6 +426,7 @@ error_code sys_spu_thread_group_start(ppu_thread& ppu, u32 id)
 			auto& img = group->imgs[thread->index];
 
 			sys_spu_image::deploy(thread->offset, img.second.data(), img.first.nsegs);
+			thread->ls_modified(0, 0x40000);
 
 			thread->pc = img.first.entry_point;
 			thread->cpu_init();
@@ -775,6 +817,8 @@ error_code sys_spu_thread_write_ls(u32 id, u32 lsa, u64 value, u32 type)
 	default: return CELL_EINVAL;
 	}
 
+	thread->ls_modified(lsa, type);
+
 	return CELL_OK;
 }
 
@@ -198,6 +198,7 @@ struct sys_spu_image
 	void load(const fs::file& stream);
 	void free();
 	static void deploy(u32 loc, sys_spu_segment* segs, u32 nsegs);
+	static void precompile(const sys_spu_segment* segs, u32 nsegs, u32 entry);
 };
 
 enum : u32
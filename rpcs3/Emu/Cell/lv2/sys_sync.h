@@ -11,6 +11,13 @@
 #include "Emu/IPC.h"
 
 #include <deque>
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
 
 // attr_protocol (waiting scheduling policy)
 enum
@@ -55,6 +62,114 @@ enum
 	SYS_SYNC_ATTR_ADAPTIVE_MASK  = 0xf000,
 };
 
+// Scheduler queue for PPU threads: FIFO bucket for each priority and the bitmap of non-empty buckets
+class lv2_ppu_queue
+{
+	static const u32 prio_count = 3072;
+
+	// First and last threads in the buckets (linked with ppu_thread::sched_prev, sched_next)
+	std::array<class ppu_thread*, prio_count> m_head{};
+	std::array<class ppu_thread*, prio_count> m_tail{};
+
+	// Non-empty buckets
+	std::array<u64, prio_count / 64> m_bits{};
+
+	// Non-empty words of m_bits
+	u64 m_mask = 0;
+
+	std::size_t m_size = 0;
+
+	// Find first non-empty bucket starting from the priority (returns prio_count if not found)
+	u32 find(u32 prio) const;
+
+public:
+	// Check whether the thread is queued
+	bool contains(const ppu_thread* ppu) const;
+
+	// Add the thread to the end of the bucket of its current priority
+	void push(ppu_thread* ppu);
+
+	// Remove the thread (returns false if not queued)
+	bool remove(ppu_thread* ppu);
+
+	// Get the first thread in scheduling order
+	ppu_thread* front() const;
+
+	// Get the thread following the specified one in scheduling order
+	ppu_thread* next(const ppu_thread* ppu) const;
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	void clear();
+};
+
+// Timer service for lv2 timeouts and timers: single thread driven by a hierarchical timing wheel
+class lv2_timer_service
+{
+public:
+	using callback = std::function<void()>;
+
+	~lv2_timer_service();
+
+	// Call the function (from the timer thread) at the specified time, returns handle (never 0)
+	u64 add(u64 when, callback func);
+
+	// Remove the callback (returns false if it was already called or not found)
+	bool cancel(u64 handle);
+
+	// Stop the thread and drop all callbacks
+	void clear();
+
+private:
+	// 4 levels of 256 slots (1 us resolution, ~71 minutes range)
+	static const u32 slot_bits = 8;
+	static const u32 slot_count = 1 << slot_bits;
+	static const u32 level_count = 4;
+
+	struct level
+	{
+		// Handles (removed lazily when cancelled)
+		std::array<std::vector<u64>, slot_count> slots;
+
+		// Non-empty slots
+		std::array<u64, slot_count / 64> bits{};
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	// Active callbacks (handle -> deadline, function)
+	std::unordered_map<u64, std::pair<u64, callback>> m_funcs;
+
+	std::array<level, level_count> m_wheel;
+
+	// Next time unit to process
+	u64 m_time = 0;
+
+	u64 m_last_handle = 0;
+
+	// Planned wakeup time of the thread
+	u64 m_wakeup = UINT64_MAX;
+
+	std::shared_ptr<thread_ctrl> m_thread;
+
+	bool m_stop = false;
+
+	void run();
+
+	// Put the handle into the wheel
+	void insert(u64 handle, u64 when);
+
+	// Get the earliest time the wheel needs to be processed at (UINT64_MAX if empty)
+	u64 next() const;
+
+	// Process the wheel up to the time, collect expired callbacks
+	void advance(u64 now, std::vector<callback>& out);
+};
+
 // Base class for some kernel objects (shared set of 8192 objects).
 struct lv2_obj
 {
@@ -132,6 +247,9 @@ struct lv2_obj
 
 	static void cleanup();
 
+	// Timer service (must not be used after cleanup)
+	static lv2_timer_service g_timer;
+
 	template <typename T, typename F>
 	static error_code create(u32 pshared, u64 ipc_key, s32 flags, F&& make)
 	{
@@ -212,13 +330,13 @@ private:
 	static semaphore<> g_mutex;
 
 	// Scheduler queue for active PPU threads
-	static std::deque<class ppu_thread*> g_ppu;
+	static lv2_ppu_queue g_ppu;
 
 	// Waiting for the response from
 	static std::deque<class cpu_thread*> g_pending;
 
-	// Scheduler queue for timeouts (wait until -> thread)
-	static std::deque<std::pair<u64, named_thread*>> g_waiting;
+	// Registered timeouts (thread -> timer service handle)
+	static std::unordered_map<named_thread*, u64> g_waiting;
 
 	static void schedule_all();
 };
@@ -9,67 +9,66 @@
 #include "sys_process.h"
 #include "sys_timer.h"
 
-#include <thread>
-
 namespace vm { using namespace ps3; }
 
 logs::channel sys_timer("sys_timer");
 
 extern u64 get_system_time();
 
-void lv2_timer::on_task()
+// Remove registered expiration (timer mutex must be locked)
+static void timer_disarm(lv2_timer& timer)
 {
-	while (!Emu.IsStopped())
+	if (timer.handle)
 	{
-		const u32 _state = state;
+		lv2_obj::g_timer.cancel(timer.handle);
+		timer.handle = 0;
+	}
 
-		if (_state == SYS_TIMER_STATE_RUN)
-		{
-			const u64 _now = get_system_time();
-			const u64 next = expire;
+	timer.stamp++;
+}
 
-			if (_now >= next)
-			{
-				semaphore_lock lock(mutex);
-
-				if (const auto queue = port.lock())
-				{
-					queue->send(source, data1, data2, next);
-
-					if (period)
-					{
-						// Set next expiration time and check again (HACK)
-						expire += period;
-						continue;
-					}
-				}
-
-				// Stop: oneshot or the event port was disconnected (TODO: is it correct?)
-				state = SYS_TIMER_STATE_STOP; 
-				continue;
-			}
+// Register next expiration in the timer service (timer mutex must be locked)
+static void timer_arm(const std::shared_ptr<lv2_timer>& timer)
+{
+	const std::weak_ptr<lv2_timer> ptr = timer;
+	const u64 stamp = ++timer->stamp;
+
+	timer->handle = lv2_obj::g_timer.add(timer->expire, [ptr, stamp]()
+	{
+		const auto _timer = ptr.lock();
 
-			// TODO: use single global dedicated thread for busy waiting, no timer threads
-			lv2_obj::sleep_timeout(*this, next - _now);
-			thread_ctrl::wait_for(next - _now);
+		if (!_timer)
+		{
+			return;
 		}
-		else if (_state == SYS_TIMER_STATE_STOP)
+
+		semaphore_lock lock(_timer->mutex);
+
+		if (_timer->stamp != stamp || _timer->state != SYS_TIMER_STATE_RUN)
 		{
-			thread_ctrl::wait_for(10000);
+			// Stopped or restarted
+			return;
 		}
-		else
+
+		_timer->handle = 0;
+
+		if (const auto queue = _timer->port.lock())
 		{
-			break;
+			const u64 next = _timer->expire;
+			queue->send(_timer->source, _timer->data1, _timer->data2, next);
+
+			if (_timer->period)
+			{
+				// Set next expiration time
+				_timer->expire += _timer->period;
+				timer_arm(_timer);
+				return;
+			}
 		}
-	}
-}
 
-void lv2_timer::on_stop()
-{
-	// Signal thread using invalid state
-	state = -1;
-	notify();
-	join();
+		// Stop: oneshot or the event port was disconnected (TODO: is it correct?)
+		_timer->state = SYS_TIMER_STATE_STOP;
+	});
 }
 
 error_code sys_timer_create(vm::ptr<u32> timer_id)
@@ -153,38 +152,30 @@ error_code _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 		return CELL_EINVAL;
 	}
 
-	const auto timer = idm::check<lv2_obj, lv2_timer>(timer_id, [&](lv2_timer& timer) -> CellError
-	{
-		semaphore_lock lock(timer.mutex);
-
-		if (timer.state != SYS_TIMER_STATE_STOP)
-		{
-			return CELL_EBUSY;
-		}
-
-		if (timer.port.expired())
-		{
-			return CELL_ENOTCONN;
-		}
-
-		// sys_timer_start_periodic() will use current time (TODO: is it correct?)
-		timer.expire = base_time ? base_time : start_time + period;
-		timer.period = period;
-		timer.state  = SYS_TIMER_STATE_RUN;
-		timer.notify();
-		return {};
-	});
+	const auto timer = idm::get<lv2_obj, lv2_timer>(timer_id);
 
 	if (!timer)
 	{
 		return CELL_ESRCH;
 	}
 
-	if (timer.ret)
+	semaphore_lock lock(timer->mutex);
+
+	if (timer->state != SYS_TIMER_STATE_STOP)
 	{
-		return timer.ret;
+		return CELL_EBUSY;
+	}
+
+	if (timer->port.expired())
+	{
+		return CELL_ENOTCONN;
 	}
 
+	// sys_timer_start_periodic() will use current time (TODO: is it correct?)
+	timer->expire = base_time ? base_time : start_time + period;
+	timer->period = period;
+	timer->state  = SYS_TIMER_STATE_RUN;
+	timer_arm(timer);
 	return CELL_OK;
 }
 
@@ -197,6 +188,7 @@ error_code sys_timer_stop(u32 timer_id)
 		semaphore_lock lock(timer.mutex);
 
 		timer.state = SYS_TIMER_STATE_STOP;
+		timer_disarm(timer);
 	});
 
 	if (!timer)
@@ -262,6 +254,7 @@ error_code sys_timer_disconnect_event_queue(u32 timer_id)
 		}
 
 		timer.state = SYS_TIMER_STATE_STOP;
+		timer_disarm(timer);
 		timer.port.reset();
 		return {};
 	});
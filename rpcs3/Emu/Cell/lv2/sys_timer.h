@@ -17,13 +17,10 @@ struct sys_timer_information_t
 	be_t<u32> pad;
 };
 
-struct lv2_timer final : public lv2_obj, public named_thread
+struct lv2_timer final : public lv2_obj
 {
 	static const u32 id_base = 0x11000000;
 
-	void on_task() override;
-	void on_stop() override;
-
 	semaphore<> mutex;
 	atomic_t<u32> state{SYS_TIMER_STATE_STOP};
 
@@ -34,6 +31,9 @@ struct lv2_timer final : public lv2_obj, public named_thread
 	
 	atomic_t<u64> expire{0}; // Next expiration time
 	atomic_t<u64> period{0}; // Period (oneshot if 0)
+
+	u64 handle = 0; // Timer service callback (0 if not registered)
+	u64 stamp = 0; // Incremented on every (un)registration to ignore stale callbacks
 };
 
 class ppu_thread;
@@ -5,6 +5,7 @@ shared_mutex id_manager::g_mutex;
 
 thread_local DECLARE(idm::g_id);
 DECLARE(idm::g_map);
+DECLARE(idm::g_tables);
 DECLARE(fxm::g_vec);
 
 id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32 base, u32 step, u32 count)
@@ -12,6 +13,15 @@ id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32
 	// Base type id is stored in value
 	auto& vec = g_map[info.value()];
 
+	auto& table = g_tables[info.value()];
+
+	if (!table.slots)
+	{
+		// Allocate lookup table (size must be set first)
+		table.size = count;
+		table.slots = new id_slot[count];
+	}
+
 	// Preallocate memory
 	vec.reserve(count);
 
@@ -46,10 +56,36 @@ id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32
 	return nullptr;
 }
 
+void idm::update_slot(u32 type, id_manager::id_map::pointer place)
+{
+	const u32 index = ::narrow<u32>(place - g_map[type].data());
+
+	auto& table = g_tables[type];
+
+	if (index < table.size)
+	{
+		auto& slot = table.slots.load()[index];
+
+		// Copy new object (or nullptr) under the spinlock
+		std::shared_ptr<void> old;
+
+		lock_slot(slot);
+		slot.type = place->first.type();
+		old = std::exchange(slot.ptr, place->second);
+		unlock_slot(slot);
+	}
+}
+
 void idm::init()
 {
 	// Allocate
 	g_map.resize(id_manager::typeinfo::get_count());
+
+	if (!g_tables)
+	{
+		g_tables.reset(new id_table[id_manager::typeinfo::get_count()]);
+	}
+
 	idm::clear();
 }
 
@@ -70,6 +106,23 @@ void idm::clear()
 
 		map.clear();
 	}
+
+	// Clear lookup tables
+	for (u32 i = 0; g_tables && i < g_map.size(); i++)
+	{
+		auto& table = g_tables[i];
+
+		for (u32 j = 0; table.slots && j < table.size; j++)
+		{
+			auto& slot = table.slots.load()[j];
+
+			std::shared_ptr<void> old;
+
+			lock_slot(slot);
+			old = std::move(slot.ptr);
+			unlock_slot(slot);
+		}
+	}
 }
 
 void fxm::init()
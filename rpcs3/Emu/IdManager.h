@@ -183,6 +183,64 @@ class idm
 	// Type Index -> ID -> Object. Use global since only one process is supported atm.
 	static std::vector<id_manager::id_map> g_map;
 
+	// Lock-free lookup table entry (mirrors id_map entry, modified under the writer lock)
+	struct id_slot
+	{
+		atomic_t<u32> lock{0};
+		u32 type = 0;
+		std::shared_ptr<void> ptr;
+	};
+
+	// Lookup table for the type index (fixed capacity, allocated on first use and never reallocated)
+	struct id_table
+	{
+		atomic_t<id_slot*> slots{nullptr};
+		atomic_t<u32> size{0};
+
+		~id_table()
+		{
+			delete[] slots.load();
+		}
+	};
+
+	// Type Index -> lookup table
+	static std::unique_ptr<id_table[]> g_tables;
+
+	// Update lookup table entry for the id_map entry (must be called under the writer lock)
+	static void update_slot(u32 type, id_manager::id_map::pointer place);
+
+	// Find lookup table entry (doesn't check the object type, returns nullptr if it's not covered)
+	template <typename T, typename Type>
+	static inline id_slot* find_slot(u32 id)
+	{
+		static_assert(id_manager::id_verify<T, Type>::value, "Invalid ID type combination");
+
+		const u32 index = get_index<Type>(id);
+
+		auto& table = g_tables[get_type<T>()];
+
+		if (index >= table.size || index >= id_manager::id_traits<Type>::count)
+		{
+			return nullptr;
+		}
+
+		return table.slots.load() + index;
+	}
+
+	// Slot spinlock (only protects copying the pointer)
+	static inline void lock_slot(id_slot& slot)
+	{
+		while (UNLIKELY(slot.lock.exchange(1)))
+		{
+			busy_wait(10);
+		}
+	}
+
+	static inline void unlock_slot(id_slot& slot)
+	{
+		slot.lock.store(0);
+	}
+
 	template <typename T>
 	static inline u32 get_type()
 	{
@@ -316,6 +374,7 @@ class idm
 
 			if (place->second)
 			{
+				update_slot(get_type<T>(), place);
 				return place;
 			}
 		}
@@ -407,10 +466,18 @@ public:
 		return nullptr;
 	}
 
-	// Check the ID
+	// Check the ID (lock-free unless the ID is not covered by the lookup table)
 	template <typename T, typename Get = T>
 	static inline Get* check(u32 id)
 	{
+		if (const auto slot = find_slot<T, Get>(id))
+		{
+			lock_slot(*slot);
+			const auto ptr = std::is_same<T, Get>::value || slot->type == get_type<Get>() ? slot->ptr.get() : nullptr;
+			unlock_slot(*slot);
+			return static_cast<Get*>(ptr);
+		}
+
 		reader_lock lock(id_manager::g_mutex);
 
 		return check_unlocked<T, Get>(id);
@@ -459,10 +526,25 @@ public:
 		return {found->second, static_cast<Get*>(found->second.get())};
 	}
 
-	// Get the object
+	// Get the object (lock-free unless the ID is not covered by the lookup table)
 	template <typename T, typename Get = T>
 	static inline std::shared_ptr<Get> get(u32 id)
 	{
+		if (const auto slot = find_slot<T, Get>(id))
+		{
+			std::shared_ptr<void> ptr;
+
+			lock_slot(*slot);
+
+			if (std::is_same<T, Get>::value || slot->type == get_type<Get>())
+			{
+				ptr = slot->ptr;
+			}
+
+			unlock_slot(*slot);
+			return {ptr, static_cast<Get*>(ptr.get())};
+		}
+
 		reader_lock lock(id_manager::g_mutex);
 
 		const auto found = find_id<T, Get>(id);
@@ -581,6 +663,7 @@ public:
 			if (const auto found = find_id<T, Get>(id))
 			{
 				ptr = std::move(found->second);
+				update_slot(get_type<T>(), found);
 			}
 			else
 			{
@@ -603,6 +686,7 @@ public:
 			if (const auto found = find_id<T, Get>(id))
 			{
 				ptr = std::move(found->second);
+				update_slot(get_type<T>(), found);
 			}
 			else
 			{
@@ -629,6 +713,7 @@ public:
 				func(*static_cast<Get*>(found->second.get()));
 
 				ptr = std::move(found->second);
+				update_slot(get_type<T>(), found);
 			}
 			else
 			{
@@ -663,6 +748,7 @@ public:
 				}
 
 				ptr = std::move(found->second);
+				update_slot(get_type<T>(), found);
 			}
 			else
 			{
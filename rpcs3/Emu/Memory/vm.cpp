@@ -9,7 +9,6 @@
 #include "Emu/RSX/GSRender.h"
 
 #include <atomic>
-#include <deque>
 
 namespace vm
 {
@@ -42,8 +41,24 @@ namespace vm
 	// Reservations (lock lines) in a single memory page
 	using reservation_info = std::array<std::atomic<u64>, 4096 / 128>;
 
-	// Registered waiters
-	std::deque<vm::waiter*> g_waiters;
+	// Registered waiters with the same lock line hash
+	struct waiter_bucket
+	{
+		shared_mutex mutex;
+
+		// Number of waiters (checked without locking)
+		atomic_t<u32> count{0};
+
+		std::vector<vm::waiter*> list;
+	};
+
+	// Registered waiters (hash table indexed by lock line address)
+	std::array<waiter_bucket, 256> g_waiters;
+
+	static waiter_bucket& get_waiters(u32 addr)
+	{
+		return g_waiters[((addr / 128) * 0x9e3779b1u) >> 24];
+	}
 
 	// Memory mutex core
 	shared_mutex g_mutex;
@@ -51,21 +66,98 @@ namespace vm
 	// Memory mutex acknowledgement
 	thread_local atomic_t<cpu_thread*>* g_tls_locked = nullptr;
 
-	// Memory mutex: passive locks
-	std::array<atomic_t<cpu_thread*>, 32> g_locks;
+	// Memory mutex: passive locks (list of blocks growing on demand, never freed)
+	struct passive_lock_block
+	{
+		std::array<atomic_t<cpu_thread*>, 64> slots{};
+
+		atomic_t<passive_lock_block*> next{nullptr};
+	};
+
+	passive_lock_block g_locks;
+
+	// Last passive lock slot used by the current thread
+	static thread_local atomic_t<cpu_thread*>* g_tls_slot = nullptr;
+
+	template <typename F>
+	static void _for_each_lock(F&& func)
+	{
+		for (auto block = &g_locks; block; block = block->next)
+		{
+			for (auto& lock : block->slots)
+			{
+				func(lock);
+			}
+		}
+	}
 
 	static void _register_lock(cpu_thread* _cpu)
 	{
-		for (u32 i = 0;; i = (i + 1) % g_locks.size())
+		// Try to reuse the previous slot
+		if (g_tls_slot && g_tls_slot->compare_and_swap_test(nullptr, _cpu))
+		{
+			g_tls_locked = g_tls_slot;
+			return;
+		}
+
+		for (auto block = &g_locks;;)
 		{
-			if (!g_locks[i] && g_locks[i].compare_and_swap_test(nullptr, _cpu))
+			for (auto& lock : block->slots)
 			{
-				g_tls_locked = g_locks.data() + i;
-				return;
+				if (!lock && lock.compare_and_swap_test(nullptr, _cpu))
+				{
+					g_tls_locked = g_tls_slot = &lock;
+					return;
+				}
 			}
+
+			auto next = block->next.load();
+
+			if (!next)
+			{
+				// All slots are occupied: append new block
+				const auto _new = new passive_lock_block;
+
+				if ((next = block->next.compare_and_swap(nullptr, _new)))
+				{
+					delete _new;
+				}
+				else
+				{
+					next = _new;
+				}
+			}
+
+			block = next;
 		}
 	}
 
+	// Wait until every registered thread passes through check_state() (vm::g_mutex must be locked)
+	static void _wait_for_readers()
+	{
+		_for_each_lock([](atomic_t<cpu_thread*>& lock)
+		{
+			if (cpu_thread* ptr = lock)
+			{
+				ptr->state.test_and_set(cpu_flag::memory);
+			}
+		});
+
+		_for_each_lock([](atomic_t<cpu_thread*>& lock)
+		{
+			while (cpu_thread* ptr = lock)
+			{
+				// cpu_flag::memory is reset before unregistering, the thread doesn't wait for the writer
+				if (!test(ptr->state, cpu_flag::memory) || test(ptr->state, cpu_flag::dbg_global_stop + cpu_flag::exit))
+				{
+					break;
+				}
+
+				busy_wait();
+			}
+		});
+	}
+
 	void passive_lock(cpu_thread& cpu)
 	{
 		if (g_tls_locked && *g_tls_locked == &cpu)
@@ -73,8 +165,6 @@ namespace vm
 			return;
 		}
 
-		::reader_lock lock(g_mutex);
-
 		_register_lock(&cpu);
 	}
 
@@ -83,7 +173,6 @@ namespace vm
 		if (g_tls_locked)
 		{
 			g_tls_locked->compare_and_swap_test(&cpu, nullptr);
-			::reader_lock lock(g_mutex);
 			g_tls_locked = nullptr;
 		}
 	}
@@ -95,14 +184,13 @@ namespace vm
 			g_tls_locked = nullptr;
 		}
 
-		for (u32 i = 0; i < g_locks.size(); i++)
+		_for_each_lock([&](atomic_t<cpu_thread*>& lock)
 		{
-			if (g_locks[i] == &cpu)
+			if (lock == &cpu)
 			{
-				g_locks[i].compare_and_swap_test(&cpu, nullptr);
-				return;
+				lock.compare_and_swap_test(&cpu, nullptr);
 			}
-		}
+		});
 	}
 
 	void temporary_unlock(cpu_thread& cpu) noexcept
@@ -167,26 +255,7 @@ namespace vm
 
 		if (full)
 		{
-			for (auto& lock : g_locks)
-			{
-				if (cpu_thread* ptr = lock)
-				{
-					ptr->state.test_and_set(cpu_flag::memory);
-				}
-			}
-
-			for (auto& lock : g_locks)
-			{
-				while (cpu_thread* ptr = lock)
-				{
-					if (test(ptr->state, cpu_flag::dbg_global_stop + cpu_flag::exit))
-					{
-						break;
-					}
-
-					busy_wait();
-				}
-			}
+			_wait_for_readers();
 		}
 
 		if (cpu)
@@ -250,18 +319,67 @@ namespace vm
 		return g_pages[addr >> 12][addr].load(std::memory_order_acquire);
 	}
 
+	u64 reservation_wait(u32 addr, u32 _size)
+	{
+		auto& res = g_pages[addr >> 12][addr];
+
+		while (true)
+		{
+			const u64 stamp = res.load(std::memory_order_acquire);
+
+			if (LIKELY(!(stamp & 1)))
+			{
+				return stamp;
+			}
+
+			busy_wait(100);
+		}
+	}
+
+	bool reservation_trylock(u32 addr, u64 stamp)
+	{
+		// Set the lock bit only if nobody has updated the lock line (unsafe, assume allocated)
+		return (*g_pages[addr >> 12].reservations)[(addr & 0xfff) >> 7].compare_exchange_strong(stamp, stamp | 1, std::memory_order_acquire);
+	}
+
+	u64 reservation_lock(u32 addr, u32 _size)
+	{
+		auto& res = g_pages[addr >> 12][addr];
+
+		while (true)
+		{
+			u64 stamp = res.load(std::memory_order_relaxed);
+
+			if (LIKELY(!(stamp & 1)) && res.compare_exchange_weak(stamp, stamp | 1, std::memory_order_acquire))
+			{
+				return stamp;
+			}
+
+			busy_wait(100);
+		}
+	}
+
+	void reservation_unlock(u32 addr, u64 stamp)
+	{
+		(*g_pages[addr >> 12].reservations)[(addr & 0xfff) >> 7].store(stamp, std::memory_order_release);
+	}
+
 	void reservation_update(u32 addr, u32 _size)
 	{
-		// Update reservation info with new timestamp (unsafe, assume allocated)
-		(*g_pages[addr >> 12].reservations)[(addr & 0xfff) >> 7].store(__rdtsc(), std::memory_order_release);
+		// Update reservation info with new timestamp (unsafe, assume allocated), clear the lock bit
+		(*g_pages[addr >> 12].reservations)[(addr & 0xfff) >> 7].store(__rdtsc() & ~1ull, std::memory_order_release);
 	}
 
 	void waiter::init()
 	{
 		// Register waiter
-		writer_lock lock(0);
+		auto& bucket = get_waiters(addr);
+
+		::writer_lock lock(bucket.mutex);
 
-		g_waiters.emplace_back(this);
+		bucket.list.emplace_back(this);
+		bucket.count++;
+		registered = true;
 	}
 
 	void waiter::test() const
@@ -291,21 +409,42 @@ namespace vm
 
 	waiter::~waiter()
 	{
+		if (!registered)
+		{
+			return;
+		}
+
 		// Unregister waiter
-		writer_lock lock(0);
+		auto& bucket = get_waiters(addr);
+
+		::writer_lock lock(bucket.mutex);
 
 		// Find waiter
-		const auto found = std::find(g_waiters.cbegin(), g_waiters.cend(), this);
+		const auto found = std::find(bucket.list.begin(), bucket.list.end(), this);
 
-		if (found != g_waiters.cend())
+		if (found != bucket.list.end())
 		{
-			g_waiters.erase(found);
+			*found = bucket.list.back();
+			bucket.list.pop_back();
+			bucket.count--;
 		}
 	}
 
 	void notify(u32 addr, u32 size)
 	{
-		for (const waiter* ptr : g_waiters)
+		auto& bucket = get_waiters(addr);
+
+		// Order the preceding memory update before the check (pairs with the RMW in waiter::init)
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (!bucket.count)
+		{
+			return;
+		}
+
+		::reader_lock lock(bucket.mutex);
+
+		for (const waiter* ptr : bucket.list)
 		{
 			if (ptr->addr / 128 == addr / 128)
 			{
@@ -316,9 +455,21 @@ namespace vm
 
 	void notify_all()
 	{
-		for (const waiter* ptr : g_waiters)
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		for (auto& bucket : g_waiters)
 		{
-			ptr->test();
+			if (!bucket.count)
+			{
+				continue;
+			}
+
+			::reader_lock lock(bucket.mutex);
+
+			for (const waiter* ptr : bucket.list)
+			{
+				ptr->test();
+			}
 		}
 	}
 
@@ -360,7 +511,7 @@ namespace vm
 
 	bool page_protect(u32 addr, u32 size, u8 flags_test, u8 flags_set, u8 flags_clear)
 	{
-		writer_lock lock;
+		writer_lock lock(0);
 
 		if (!size || (size | addr) % 4096)
 		{
@@ -386,6 +537,17 @@ namespace vm
 			return true;
 		}
 
+		if (flags_clear)
+		{
+			// Revoke access first, then wait for the threads which may still access the pages with old flags
+			for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
+			{
+				g_pages[i].flags &= ~flags_clear;
+			}
+
+			_wait_for_readers();
+		}
+
 		u8 start_value = 0xff;
 
 		for (u32 start = addr / 4096, end = start + size / 4096, i = start; i < end + 1; i++)
@@ -394,10 +556,7 @@ namespace vm
 
 			if (i < end)
 			{
-				g_pages[i].flags |= flags_set;
-				g_pages[i].flags &= ~flags_clear;
-
-				new_val = g_pages[i].flags & (page_readable | page_writable);
+				new_val = (g_pages[i].flags | flags_set) & (page_readable | page_writable);
 			}
 
 			if (new_val != start_value)
@@ -413,6 +572,12 @@ namespace vm
 			}
 		}
 
+		// Grant access after the memory protection has been changed
+		for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
+		{
+			g_pages[i].flags |= flags_set;
+		}
+
 		return true;
 	}
 
@@ -439,6 +604,9 @@ namespace vm
 			}
 		}
 
+		// Pages are no longer visible, wait for the threads which may still access them
+		_wait_for_readers();
+
 		utils::memory_decommit(g_base_addr + addr, size);
 		utils::memory_decommit(g_exec_addr + addr, size);
 
@@ -546,7 +714,7 @@ namespace vm
 
 	block_t::~block_t()
 	{
-		writer_lock lock;
+		writer_lock lock(0);
 
 		// Deallocate all memory
 		for (auto& entry : m_map)
@@ -557,7 +725,7 @@ namespace vm
 
 	u32 block_t::alloc(const u32 orig_size, u32 align, const uchar* data, u32 sup)
 	{
-		writer_lock lock;
+		writer_lock lock(0);
 
 		// Align to minimal page size
 		const u32 size = ::align(orig_size, 4096);
@@ -604,7 +772,7 @@ namespace vm
 
 	u32 block_t::falloc(u32 addr, const u32 orig_size, const uchar* data, u32 sup)
 	{
-		writer_lock lock;
+		writer_lock lock(0);
 
 		// align to minimal page size
 		const u32 size = ::align(orig_size, 4096);
@@ -641,7 +809,7 @@ namespace vm
 
 	u32 block_t::dealloc(u32 addr, uchar* data_out, u32* sup_out)
 	{
-		writer_lock lock;
+		writer_lock lock(0);
 
 		const auto found = m_map.find(addr);
 
@@ -46,6 +46,9 @@ namespace vm
 		u64 stamp;
 		const void* data;
 
+		// Registered in the waiter table (set by init())
+		bool registered = false;
+
 		waiter() = default;
 
 		waiter(const waiter&) = delete;
@@ -93,6 +96,8 @@ namespace vm
 		const bool locked;
 
 		writer_lock(const writer_lock&) = delete;
+
+		// full: also wait until all passively locked threads acknowledge (they don't wait for the writer)
 		writer_lock(int full = 1);
 		writer_lock(const try_to_lock_t&);
 		~writer_lock();
@@ -100,10 +105,22 @@ namespace vm
 		explicit operator bool() const { return locked; }
 	};
 
-	// Get reservation status for further atomic update: last update timestamp
+	// Get reservation status for further atomic update: last update timestamp (bit 0 is the lock bit)
 	u64 reservation_acquire(u32 addr, u32 size);
 
-	// End atomic update
+	// Get reservation timestamp, wait while the lock line is locked
+	u64 reservation_wait(u32 addr, u32 size);
+
+	// Lock the lock line if its timestamp is unchanged (returns false otherwise)
+	bool reservation_trylock(u32 addr, u64 stamp);
+
+	// Lock the lock line unconditionally, returns previous timestamp
+	u64 reservation_lock(u32 addr, u32 size);
+
+	// Unlock the lock line without update (restore timestamp)
+	void reservation_unlock(u32 addr, u64 stamp);
+
+	// End atomic update (set new timestamp, also unlocks the lock line)
 	void reservation_update(u32 addr, u32 size);
 
 	// Check and notify memory changes at address
@@ -45,6 +45,8 @@ namespace
 		__m128i* dst_ptr = (__m128i*)dst;
 		__m128i* src_ptr = (__m128i*)src;
 
+		const bool dst_aligned = ((u64)dst & 15) == 0;
+
 		const u32 dword_count = (vertex_count * (stride >> 2));
 		const u32 iterations = dword_count >> 2;
 		const u32 remaining = dword_count % 4;
@@ -55,7 +57,11 @@ namespace
 			u32 *dst_words = (u32*)dst_ptr;
 			const __m128i &vector = _mm_loadu_si128(src_ptr);
 			const __m128i &shuffled_vector = _mm_shuffle_epi8(vector, mask);
-			_mm_stream_si128(dst_ptr, shuffled_vector);
+
+			if (dst_aligned)
+				_mm_stream_si128(dst_ptr, shuffled_vector);
+			else
+				_mm_storeu_si128(dst_ptr, shuffled_vector);
 
 			src_ptr++;
 			dst_ptr++;
@@ -82,6 +88,8 @@ namespace
 		__m128i* dst_ptr = (__m128i*)dst;
 		__m128i* src_ptr = (__m128i*)src;
 
+		const bool dst_aligned = ((u64)dst & 15) == 0;
+
 		const u32 word_count = (vertex_count * (stride >> 1));
 		const u32 iterations = word_count >> 3;
 		const u32 remaining = word_count % 8;
@@ -92,7 +100,11 @@ namespace
 			u32 *dst_words = (u32*)dst_ptr;
 			const __m128i &vector = _mm_loadu_si128(src_ptr);
 			const __m128i &shuffled_vector = _mm_shuffle_epi8(vector, mask);
-			_mm_stream_si128(dst_ptr, shuffled_vector);
+
+			if (dst_aligned)
+				_mm_stream_si128(dst_ptr, shuffled_vector);
+			else
+				_mm_storeu_si128(dst_ptr, shuffled_vector);
 
 			src_ptr++;
 			dst_ptr++;
@@ -267,6 +279,67 @@ namespace
 		}
 	}
 
+	/**
+	 * Decode CMP vectors four at a time, see decode_cmp_vector.
+	 * Each vertex is written as 4 u16 (8 bytes) at dst_stride intervals.
+	 */
+	void stream_cmp_data_to_memory(void *dst, const void *src, u32 vertex_count, u8 dst_stride, u32 src_stride)
+	{
+		const __m128i bswap_mask = _mm_set_epi8(
+			0xC, 0xD, 0xE, 0xF,
+			0x8, 0x9, 0xA, 0xB,
+			0x4, 0x5, 0x6, 0x7,
+			0x0, 0x1, 0x2, 0x3);
+
+		const __m128i xy_mask = _mm_set1_epi32(0xFFE0);
+		const __m128i z_mask = _mm_set1_epi32(0xFFC0);
+		const __m128i w_value = _mm_set1_epi32(1 << 16);
+
+		const char *src_ptr = (const char *)src;
+		char *dst_ptr = (char *)dst;
+
+		const u32 iterations = vertex_count / 4;
+
+		for (u32 i = 0; i < iterations; ++i)
+		{
+			u32 values[4];
+			for (u32 n = 0; n < 4; ++n)
+				memcpy(values + n, src_ptr + src_stride * n, sizeof(u32));
+
+			const __m128i vector = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)values), bswap_mask);
+
+			const __m128i x = _mm_and_si128(_mm_slli_epi32(vector, 5), xy_mask);
+			const __m128i y = _mm_and_si128(_mm_srli_epi32(vector, 6), xy_mask);
+			const __m128i z = _mm_and_si128(_mm_srli_epi32(vector, 16), z_mask);
+
+			// Pack as XYZW u16 quadruplets
+			const __m128i xy = _mm_or_si128(x, _mm_slli_epi32(y, 16));
+			const __m128i zw = _mm_or_si128(z, w_value);
+			const __m128i v01 = _mm_unpacklo_epi32(xy, zw);
+			const __m128i v23 = _mm_unpackhi_epi32(xy, zw);
+
+			_mm_storel_epi64((__m128i*)dst_ptr, v01);
+			_mm_storel_epi64((__m128i*)(dst_ptr + dst_stride), _mm_unpackhi_epi64(v01, v01));
+			_mm_storel_epi64((__m128i*)(dst_ptr + dst_stride * 2), v23);
+			_mm_storel_epi64((__m128i*)(dst_ptr + dst_stride * 3), _mm_unpackhi_epi64(v23, v23));
+
+			src_ptr += src_stride * 4;
+			dst_ptr += dst_stride * 4;
+		}
+
+		for (u32 i = iterations * 4; i < vertex_count; ++i)
+		{
+			be_t<u32> src_value;
+			memcpy(&src_value, src_ptr, sizeof(be_t<u32>));
+
+			const auto& decoded_vector = decode_cmp_vector(src_value);
+			memcpy(dst_ptr, decoded_vector.data(), sizeof(u16) * 4);
+
+			src_ptr += src_stride;
+			dst_ptr += dst_stride;
+		}
+	}
+
 	template <typename T, typename U, int N>
 	void copy_whole_attribute_array_impl(void *raw_dst, void *raw_src, u8 dst_stride, u32 src_stride, u32 vertex_count)
 	{
@@ -380,9 +453,6 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	//TODO: Determine favourable vertex threshold where vector setup costs become negligible
 	//Tests show that even with 4 vertices, using traditional bswap is significantly slower over a large number of calls
 
-	const u64 src_address = (u64)src_ptr.data();
-	const bool sse_aligned = ((src_address & 15) == 0);
-	
 #if !DEBUG_VERTEX_STREAMING
 	
 	if (real_count >= count || real_count == 1)
@@ -392,6 +462,17 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 		else
 			use_stream_with_stride = true;
 	}
+	else if (real_count > 1)
+	{
+		//Repeating array: stream the supplied vertices once per repetition
+		for (u32 first = 0; first < count; first += real_count)
+		{
+			const u32 chunk_count = std::min(real_count, count - first);
+			write_vertex_array_data_to_buffer(raw_dst_span.subspan(first * dst_stride), src_ptr, chunk_count, type, vector_element_count, attribute_src_stride, dst_stride);
+		}
+
+		return;
+	}
 
 #endif
 
@@ -413,7 +494,7 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	case rsx::vertex_base_type::sf:
 	case rsx::vertex_base_type::s32k:
 	{
-		if (use_stream_no_stride && sse_aligned)
+		if (use_stream_no_stride)
 			stream_data_to_memory_swapped_u16(raw_dst_span.data(), src_ptr.data(), count, attribute_src_stride);
 		else if (use_stream_with_stride)
 			stream_data_to_memory_swapped_u16_non_continuous(raw_dst_span.data(), src_ptr.data(), count, dst_stride, attribute_src_stride);
@@ -424,7 +505,7 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	}
 	case rsx::vertex_base_type::f:
 	{
-		if (use_stream_no_stride && sse_aligned)
+		if (use_stream_no_stride)
 			stream_data_to_memory_swapped_u32(raw_dst_span.data(), src_ptr.data(), count, attribute_src_stride);
 		else if (use_stream_with_stride)
 			stream_data_to_memory_swapped_u32_non_continuous(raw_dst_span.data(), src_ptr.data(), count, dst_stride, attribute_src_stride);
@@ -435,6 +516,12 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	}
 	case rsx::vertex_base_type::cmp:
 	{
+		if (use_stream_no_stride || use_stream_with_stride)
+		{
+			stream_cmp_data_to_memory(raw_dst_span.data(), src_ptr.data(), count, dst_stride, attribute_src_stride);
+			return;
+		}
+
 		gsl::span<u16> dst_span = as_span_workaround<u16>(raw_dst_span);
 		for (u32 i = 0; i < count; ++i)
 		{
@@ -455,6 +542,165 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 
 namespace
 {
+/**
+ * SSE helpers for index buffers, processing 16 bytes of indices at a time.
+ * Indices are unsigned, SSE2 only has signed 16-bit min/max and no 32-bit min/max,
+ * so values are biased by the sign bit before comparing.
+ */
+template<typename T>
+struct index_block;
+
+template<>
+struct index_block<u16>
+{
+	static constexpr u32 count = 8;
+
+	static __m128i load(const be_t<u16>* src)
+	{
+		const __m128i mask = _mm_set_epi8(0xE, 0xF, 0xC, 0xD, 0xA, 0xB, 0x8, 0x9, 0x6, 0x7, 0x4, 0x5, 0x2, 0x3, 0x0, 0x1);
+		return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), mask);
+	}
+
+	static __m128i set1(u16 value)
+	{
+		return _mm_set1_epi16(value);
+	}
+
+	static __m128i equal(__m128i a, __m128i b)
+	{
+		return _mm_cmpeq_epi16(a, b);
+	}
+
+	static __m128i min(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi16(0x8000);
+		return _mm_xor_si128(_mm_min_epi16(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+	}
+
+	static __m128i max(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi16(0x8000);
+		return _mm_xor_si128(_mm_max_epi16(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+	}
+
+	// Two quads to two triangles each
+	static void expand_quads(u16* dst, __m128i indices)
+	{
+		const __m128i mask0 = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 4, 5, 6, 7, 0, 1, 8, 9, 10, 11);
+		const __m128i mask1 = _mm_setr_epi8(12, 13, 12, 13, 14, 15, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1);
+		_mm_storeu_si128((__m128i*)dst, _mm_shuffle_epi8(indices, mask0));
+		_mm_storel_epi64((__m128i*)(dst + 8), _mm_shuffle_epi8(indices, mask1));
+	}
+	// Eight fan triangles (anchor, previous index, index), the previous index of the first one being last
+	static void expand_fan(u16* dst, __m128i indices, u16 anchor, u16 last)
+	{
+		const __m128i previous = _mm_alignr_epi8(indices, _mm_set1_epi16(last), 14);
+		const __m128i anchors = _mm_set1_epi16(anchor);
+
+		const __m128i out0 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(previous, _mm_setr_epi8(-1, -1, 0, 1, -1, -1, -1, -1, 2, 3, -1, -1, -1, -1, 4, 5)),
+			_mm_shuffle_epi8(indices, _mm_setr_epi8(-1, -1, -1, -1, 0, 1, -1, -1, -1, -1, 2, 3, -1, -1, -1, -1))),
+			_mm_and_si128(anchors, _mm_setr_epi16(-1, 0, 0, -1, 0, 0, -1, 0)));
+
+		const __m128i out1 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(previous, _mm_setr_epi8(-1, -1, -1, -1, 6, 7, -1, -1, -1, -1, 8, 9, -1, -1, -1, -1)),
+			_mm_shuffle_epi8(indices, _mm_setr_epi8(4, 5, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1, 8, 9, -1, -1))),
+			_mm_and_si128(anchors, _mm_setr_epi16(0, -1, 0, 0, -1, 0, 0, -1)));
+
+		const __m128i out2 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(previous, _mm_setr_epi8(10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1)),
+			_mm_shuffle_epi8(indices, _mm_setr_epi8(-1, -1, 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15))),
+			_mm_and_si128(anchors, _mm_setr_epi16(0, 0, -1, 0, 0, -1, 0, 0)));
+
+		_mm_storeu_si128((__m128i*)dst, out0);
+		_mm_storeu_si128((__m128i*)(dst + 8), out1);
+		_mm_storeu_si128((__m128i*)(dst + 16), out2);
+	}
+};
+
+template<>
+struct index_block<u32>
+{
+	static constexpr u32 count = 4;
+
+	static __m128i load(const be_t<u32>* src)
+	{
+		const __m128i mask = _mm_set_epi8(0xC, 0xD, 0xE, 0xF, 0x8, 0x9, 0xA, 0xB, 0x4, 0x5, 0x6, 0x7, 0x0, 0x1, 0x2, 0x3);
+		return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), mask);
+	}
+
+	static __m128i set1(u32 value)
+	{
+		return _mm_set1_epi32(value);
+	}
+
+	static __m128i equal(__m128i a, __m128i b)
+	{
+		return _mm_cmpeq_epi32(a, b);
+	}
+
+	static __m128i min(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi32(0x80000000);
+		const __m128i a_greater = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+		return _mm_or_si128(_mm_and_si128(a_greater, b), _mm_andnot_si128(a_greater, a));
+	}
+
+	static __m128i max(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi32(0x80000000);
+		const __m128i a_greater = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+		return _mm_or_si128(_mm_and_si128(a_greater, a), _mm_andnot_si128(a_greater, b));
+	}
+
+	// One quad to two triangles
+	static void expand_quads(u32* dst, __m128i indices)
+	{
+		_mm_storeu_si128((__m128i*)dst, _mm_shuffle_epi32(indices, _MM_SHUFFLE(2, 2, 1, 0)));
+		_mm_storel_epi64((__m128i*)(dst + 4), _mm_shuffle_epi32(indices, _MM_SHUFFLE(0, 0, 0, 3)));
+	}
+	// Four fan triangles (anchor, previous index, index), the previous index of the first one being last
+	static void expand_fan(u32* dst, __m128i indices, u32 anchor, u32 last)
+	{
+		const __m128i previous = _mm_alignr_epi8(indices, _mm_set1_epi32(last), 12);
+		const __m128i anchors = _mm_set1_epi32(anchor);
+
+		const __m128i out0 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(previous, _mm_setr_epi8(-1, -1, -1, -1, 0, 1, 2, 3, -1, -1, -1, -1, -1, -1, -1, -1)),
+			_mm_shuffle_epi8(indices, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 2, 3, -1, -1, -1, -1))),
+			_mm_and_si128(anchors, _mm_setr_epi32(-1, 0, 0, -1)));
+
+		const __m128i out1 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(previous, _mm_setr_epi8(4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, 8, 9, 10, 11)),
+			_mm_shuffle_epi8(indices, _mm_setr_epi8(-1, -1, -1, -1, 4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1))),
+			_mm_and_si128(anchors, _mm_setr_epi32(0, 0, -1, 0)));
+
+		const __m128i out2 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(previous, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 12, 13, 14, 15, -1, -1, -1, -1)),
+			_mm_shuffle_epi8(indices, _mm_setr_epi8(8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, 12, 13, 14, 15))),
+			_mm_and_si128(anchors, _mm_setr_epi32(0, -1, 0, 0)));
+
+		_mm_storeu_si128((__m128i*)dst, out0);
+		_mm_storeu_si128((__m128i*)(dst + 4), out1);
+		_mm_storeu_si128((__m128i*)(dst + 8), out2);
+	}
+};
+
+// Horizontal reduction of the min/max accumulators into min_index and max_index
+template<typename T>
+void reduce_min_max(__m128i min_values, __m128i max_values, T& min_index, T& max_index)
+{
+	T values[2][index_block<T>::count];
+	_mm_storeu_si128((__m128i*)values[0], min_values);
+	_mm_storeu_si128((__m128i*)values[1], max_values);
+
+	for (u32 i = 0; i < index_block<T>::count; ++i)
+	{
+		min_index = std::min(min_index, values[0][i]);
+		max_index = std::max(max_index, values[1][i]);
+	}
+}
+
 template<typename T>
 std::tuple<T, T, u32> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
 {
@@ -463,13 +709,56 @@ std::tuple<T, T, u32> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::spa
 
 	verify(HERE), (dst.size_bytes() >= src.size_bytes());
 
+	// List types do not need primitive restart. Just skip over this instead
+	const bool skip_restart = is_primitive_restart_enabled && rsx::method_registers.current_draw_clause.is_disjoint_primitive;
+
+	using block = index_block<T>;
+	const __m128i restart = block::set1(primitive_restart_index);
+	__m128i min_values = _mm_set1_epi8(-1);
+	__m128i max_values = _mm_setzero_si128();
+
 	u32 dst_idx = 0;
-	for (T index : src)
+	u32 src_idx = 0;
+
+	for (; src_idx + block::count <= src.size(); src_idx += block::count)
 	{
+		const __m128i indices = block::load(src.data() + src_idx);
+		const __m128i restart_mask = is_primitive_restart_enabled ? block::equal(indices, restart) : _mm_setzero_si128();
+
+		if (skip_restart && _mm_movemask_epi8(restart_mask))
+		{
+			// Compact the block
+			for (u32 i = src_idx; i < src_idx + block::count; ++i)
+			{
+				const T index = src[i];
+				if (index == primitive_restart_index)
+					continue;
+
+				max_index = std::max(max_index, index);
+				min_index = std::min(min_index, index);
+				dst[dst_idx++] = index;
+			}
+
+			continue;
+		}
+
+		// Restart indices are written as -1 and excluded from min/max
+		const __m128i values = _mm_or_si128(indices, restart_mask);
+		_mm_storeu_si128((__m128i*)(dst.data() + dst_idx), values);
+		min_values = block::min(min_values, values);
+		max_values = block::max(max_values, _mm_andnot_si128(restart_mask, indices));
+		dst_idx += block::count;
+	}
+
+	reduce_min_max<T>(min_values, max_values, min_index, max_index);
+
+	for (; src_idx < src.size(); ++src_idx)
+	{
+		T index = src[src_idx];
+
 		if (is_primitive_restart_enabled && index == primitive_restart_index)
 		{
-			// List types do not need primitive restart. Just skip over this instead
-			if (rsx::method_registers.current_draw_clause.is_disjoint_primitive)
+			if (skip_restart)
 				continue;
 
 			index = -1;
@@ -495,8 +784,13 @@ std::tuple<T, T, u32> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> sr
 
 	verify(HERE), (dst.size() >= 3 * (src.size() - 2));
 
+	using block = index_block<T>;
+	const __m128i restart = block::set1(primitive_restart_index);
+	const __m128i invalid = block::set1(invalid_index);
+	__m128i min_values = _mm_set1_epi8(-1);
+	__m128i max_values = _mm_setzero_si128();
+
 	u32 dst_idx = 0;
-	u32 src_idx = 0;
 
 	bool needs_anchor = true;
 	T anchor = invalid_index;
@@ -504,6 +798,29 @@ std::tuple<T, T, u32> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> sr
 
 	for (size_t src_idx = 0; src_idx < src.size(); ++src_idx)
 	{
+		if (!needs_anchor && last_index != invalid_index && src_idx % block::count == 0 && src_idx + block::count <= src.size())
+		{
+			// Whole block inside a fan: emit one triangle per index unless a restart or invalid index needs the slow path
+			const __m128i indices = block::load(src.data() + src_idx);
+			__m128i special_mask = block::equal(indices, invalid);
+
+			if (is_primitive_restart_enabled)
+				special_mask = _mm_or_si128(special_mask, block::equal(indices, restart));
+
+			if (!_mm_movemask_epi8(special_mask))
+			{
+				min_values = block::min(min_values, indices);
+				max_values = block::max(max_values, indices);
+
+				block::expand_fan(dst.data() + dst_idx, indices, anchor, last_index);
+				dst_idx += block::count * 3;
+				last_index = src[src_idx + block::count - 1];
+
+				src_idx += block::count - 1;
+				continue;
+			}
+		}
+
 		if (needs_anchor)
 		{
 			if (is_primitive_restart_enabled && src[src_idx] == primitive_restart_index)
@@ -539,6 +856,8 @@ std::tuple<T, T, u32> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> sr
 		last_index = index;
 	}
 
+	reduce_min_max<T>(min_values, max_values, min_index, max_index);
+
 	return std::make_tuple(min_index, max_index, dst_idx);
 }
 
@@ -550,12 +869,35 @@ std::tuple<T, T, u32> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl:
 
 	verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
 
+	using block = index_block<T>;
+	const __m128i restart = block::set1(primitive_restart_index);
+	__m128i min_values = _mm_set1_epi8(-1);
+	__m128i max_values = _mm_setzero_si128();
+
 	u32 dst_idx = 0;
 	u8 set_size = 0;
 	T tmp_indices[4];
 
 	for (int src_idx = 0; src_idx < src.size(); ++src_idx)
 	{
+		if (set_size == 0 && src_idx % block::count == 0 && src_idx + block::count <= src.size())
+		{
+			// Whole quads without restart indices
+			const __m128i indices = block::load(src.data() + src_idx);
+
+			if (!is_primitive_restart_enabled || !_mm_movemask_epi8(block::equal(indices, restart)))
+			{
+				min_values = block::min(min_values, indices);
+				max_values = block::max(max_values, indices);
+
+				block::expand_quads(dst.data() + dst_idx, indices);
+				dst_idx += block::count * 6 / 4;
+
+				src_idx += block::count - 1;
+				continue;
+			}
+		}
+
 		T index = src[src_idx];
 		if (is_primitive_restart_enabled && index == primitive_restart_index)
 		{
@@ -583,6 +925,8 @@ std::tuple<T, T, u32> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl:
 		}
 	}
 
+	reduce_min_max<T>(min_values, max_values, min_index, max_index);
+
 	return std::make_tuple(min_index, max_index, dst_idx);
 }
 }
@@ -390,6 +390,15 @@ namespace rsx
 			}
 		});
 
+		m_fifo_packets.reset(new fifo_packet[fifo_packets_size]);
+		m_fifo_args.reset(new u32[fifo_args_size]);
+		m_fetch_get = internal_get;
+
+		thread_ctrl::spawn(m_fifo_thread, "RSX FIFO Thread", [this]()
+		{
+			fifo_fetch_task();
+		});
+
 		// Raise priority above other threads
 		thread_ctrl::set_native_priority(1);
 		thread_ctrl::set_ideal_processor_core(0);
@@ -404,9 +413,6 @@ namespace rsx
 		std::vector<u32> deferred_stack;
 		bool has_deferred_call = false;
 
-		// Track register address faults
-		u32 mem_faults_count = 0;
-
 		auto flush_command_queue = [&]()
 		{
 			const auto num_draws = (u32)method_registers.current_draw_clause.first_count_commands.size();
@@ -479,9 +485,8 @@ namespace rsx
 			do_local_task();
 
 			ctrl->get.store(internal_get.load());
-			const u32 put = ctrl->put;
 
-			if (put == internal_get || !Emu.IsRunning())
+			if (m_fifo_get == m_fifo_put || !Emu.IsRunning())
 			{
 				if (has_deferred_call)
 					flush_command_queue();
@@ -490,109 +495,80 @@ namespace rsx
 				continue;
 			}
 
-			//Validate put and get registers
-			//TODO: Who should handle graphics exceptions??
-			const u32 get_address = RSXIOMem.RealAddr(internal_get);
-			
-			if (!get_address)
-			{
-				LOG_ERROR(RSX, "Invalid FIFO queue get/put registers found, get=0x%X, put=0x%X", internal_get.load(), put);
-
-				if (mem_faults_count >= 3)
-				{
-					LOG_ERROR(RSX, "Application has failed to recover, discarding FIFO queue");
-					internal_get = put;
-				}
-				else
-				{
-					mem_faults_count++;
-					std::this_thread::sleep_for(1ms);
-				}
-
-				invalid_command_interrupt_raised = true;
-				continue;
-			}
-
-			const u32 cmd = ReadIO32(internal_get);
-			const u32 count = (cmd >> 18) & 0x7ff;
+			const fifo_packet& packet = m_fifo_packets[m_fifo_get % fifo_packets_size];
 
-			if ((cmd & RSX_METHOD_OLD_JUMP_CMD_MASK) == RSX_METHOD_OLD_JUMP_CMD)
-			{
-				u32 offs = cmd & 0x1ffffffc;
-				//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
-				internal_get = offs;
-				continue;
-			}
-			if ((cmd & RSX_METHOD_NEW_JUMP_CMD_MASK) == RSX_METHOD_NEW_JUMP_CMD)
-			{
-				u32 offs = cmd & 0xfffffffc;
-				//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
-				internal_get = offs;
-				continue;
-			}
-			if ((cmd & RSX_METHOD_CALL_CMD_MASK) == RSX_METHOD_CALL_CMD)
-			{
-				m_call_stack.push(internal_get + 4);
-				u32 offs = cmd & ~3;
-				//LOG_WARNING(RSX, "rsx call(0x%x) #0x%x - 0x%x", offs, cmd, get);
-				internal_get = offs;
-				continue;
-			}
-			if (cmd == RSX_METHOD_RETURN_CMD)
+			if (fifo_reset)
 			{
-				u32 get = m_call_stack.top();
-				m_call_stack.pop();
-				//LOG_WARNING(RSX, "rsx return(0x%x)", get);
-				internal_get = get;
+				// Drop commands fetched before the FIFO position reset
+				m_fifo_args_get = packet.args + packet.count;
+				m_fifo_get++;
 				continue;
 			}
-			if (cmd == 0) //nop
+
+			if (packet.flags & fifo_fault)
 			{
-				internal_get += 4;
+				invalid_command_interrupt_raised = true;
+				internal_get = packet.get;
+				m_fifo_args_get = packet.args + packet.count;
+				m_fifo_get++;
 				continue;
 			}
 
-			//Validate the args ptr if the command attempts to read from it
-			const u32 args_address = RSXIOMem.RealAddr(internal_get + 4);
+			const u32 count = packet.count;
+			const u32 first_cmd = packet.reg;
+			const u32* args = m_fifo_args.get() + packet.args % fifo_args_size;
 
-			if (!args_address && count)
+			invalid_command_interrupt_raised = false;
+
+			for (u32 i = 0; i < count; i++)
 			{
-				LOG_ERROR(RSX, "Invalid FIFO queue args ptr found, get=0x%X, cmd=0x%X, count=%d", internal_get.load(), cmd, count);
+				u32 reg = packet.flags & fifo_non_increment ? first_cmd : first_cmd + i;
+				u32 value = args[i];
 
-				if (mem_faults_count >= 3)
-				{
-					LOG_ERROR(RSX, "Application has failed to recover, discarding FIFO queue");
-					internal_get = put;
-				}
-				else
+				if (!(packet.flags & fifo_non_increment))
 				{
-					mem_faults_count++;
-					std::this_thread::sleep_for(1ms);
-				}
-
-				invalid_command_interrupt_raised = true;
-				continue;
-			}
+					// Fast path for incrementing runs: registers without side effects are copied as a block,
+					// bulk uploads (transform constants and program) are handled by their range method
+					const auto range_method = range_methods[reg];
+					u32 run = 0;
 
-			// All good on valid memory ptrs
-			mem_faults_count = 0;
+					if (!range_method)
+					{
+						// NV4097_INVALIDATE_VERTEX_FILE is left to the regular path as it doesn't flush deferred draws
+						while (i + run < count && reg + run < methods.size() && !methods[reg + run] && reg + run != NV4097_INVALIDATE_VERTEX_FILE)
+						{
+							run++;
+						}
+					}
 
-			auto args = vm::ptr<u32>::make(args_address);
-			invalid_command_interrupt_raised = false;
-			bool unaligned_command = false;
+					if (range_method || run > 1)
+					{
+						if (supports_multidraw && has_deferred_call)
+						{
+							flush_command_queue();
+						}
 
-			u32 first_cmd = (cmd & 0xfffc) >> 2;
+						if (range_method)
+						{
+							run = range_method(this, reg, args + i, count - i);
+						}
+						else
+						{
+							method_registers.decode_range(reg, args + i, run);
+						}
 
-			if (cmd & 0x3)
-			{
-				LOG_WARNING(RSX, "unaligned command: %s (0x%x from 0x%x)", get_method_name(first_cmd).c_str(), first_cmd, cmd & 0xffff);
-				unaligned_command = true;
-			}
+						if (capture_current_frame)
+						{
+							for (u32 j = 0; j < run; j++)
+							{
+								frame_debug.command_queue.push_back(std::make_pair(reg + j, args[i + j]));
+							}
+						}
 
-			for (u32 i = 0; i < count; i++)
-			{
-				u32 reg = ((cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD) ? first_cmd : first_cmd + i;
-				u32 value = args[i];
+						i += run - 1;
+						continue;
+					}
+				}
 
 				bool execute_method_call = true;
 
@@ -711,15 +687,246 @@ namespace rsx
 				}
 			}
 
-			if (unaligned_command && invalid_command_interrupt_raised)
+			if (packet.flags & fifo_unaligned && invalid_command_interrupt_raised)
 			{
 				//This is almost guaranteed to be heap corruption at this point
 				//Ignore the rest of the chain
-				internal_get = put;
+				fifo_reset = u64{1} << 32 | ctrl->put;
+			}
+			else
+			{
+				internal_get = packet.get;
+			}
+
+			m_fifo_args_get = packet.args + packet.count;
+			m_fifo_get++;
+		}
+	}
+
+	void thread::fifo_fetch_task()
+	{
+		// Track register address faults
+		u32 mem_faults_count = 0;
+
+		// Last FIFO position sent to the RSX thread
+		u32 last_get = m_fetch_get;
+
+		// Wait until the RSX thread executes all pending commands (set after semaphore acquire, which may guard command buffer updates)
+		bool barrier = false;
+
+		// Waiting iterations without progress
+		u32 idle_count = 0;
+
+		// Yield for a short time, then sleep until progress is made (the FIFO is polled, no notification is available)
+		auto idle = [&]()
+		{
+			if (idle_count < 64)
+			{
+				idle_count++;
+				std::this_thread::yield();
+			}
+			else
+			{
+				thread_ctrl::wait_for(100);
+			}
+		};
+
+		// Copy arguments and send the command to the RSX thread (m_fetch_get must point after the command)
+		auto send = [&](u32 reg, u32 count, u32 flags, u32 args_address) -> bool
+		{
+			u64 args = m_fifo_args_put;
+
+			// Arguments are never split
+			if (args % fifo_args_size + count > fifo_args_size)
+			{
+				args += fifo_args_size - args % fifo_args_size;
+			}
+
+			while (m_fifo_put - m_fifo_get >= fifo_packets_size || args + count - m_fifo_args_get > fifo_args_size)
+			{
+				if (Emu.IsStopped() || fifo_reset)
+				{
+					return false;
+				}
+
+				idle();
+			}
+
+			idle_count = 0;
+
+			const auto src = vm::ptr<u32>::make(args_address);
+			const auto dst = m_fifo_args.get() + args % fifo_args_size;
+
+			for (u32 i = 0; i < count; i++)
+			{
+				dst[i] = src[i];
+			}
+
+			m_fifo_packets[m_fifo_put % fifo_packets_size] = {reg, count, m_fetch_get, flags, args};
+			m_fifo_args_put = args + count;
+			m_fifo_put++;
+			last_get = m_fetch_get;
+			return true;
+		};
+
+		while (!Emu.IsStopped())
+		{
+			if (const u64 reset = fifo_reset)
+			{
+				// Wait until the RSX thread drops pending commands
+				if (m_fifo_get != m_fifo_put)
+				{
+					idle();
+					continue;
+				}
+
+				m_fetch_get = last_get = static_cast<u32>(reset);
+				m_call_stack = {};
+				internal_get = m_fetch_get;
+				barrier = false;
+				fifo_reset.compare_and_swap(reset, 0);
+				continue;
+			}
+
+			if (barrier)
+			{
+				if (m_fifo_get != m_fifo_put)
+				{
+					idle();
+					continue;
+				}
+
+				barrier = false;
+			}
+
+			const u32 put = ctrl->put;
+
+			if (put == m_fetch_get || !Emu.IsRunning())
+			{
+				if (last_get != m_fetch_get)
+				{
+					// Update FIFO position after jumps
+					send(0, 0, 0, 0);
+				}
+
+				idle();
+				continue;
+			}
+
+			//Validate put and get registers
+			//TODO: Who should handle graphics exceptions??
+			const u32 get_address = RSXIOMem.RealAddr(m_fetch_get);
+
+			if (!get_address)
+			{
+				LOG_ERROR(RSX, "Invalid FIFO queue get/put registers found, get=0x%X, put=0x%X", m_fetch_get, put);
+
+				if (mem_faults_count >= 3)
+				{
+					LOG_ERROR(RSX, "Application has failed to recover, discarding FIFO queue");
+					m_fetch_get = put;
+				}
+				else
+				{
+					mem_faults_count++;
+					std::this_thread::sleep_for(1ms);
+				}
+
+				// Raise the invalid command interrupt on the RSX thread
+				send(0, 0, fifo_fault, 0);
+				continue;
+			}
+
+			const u32 cmd = ReadIO32(m_fetch_get);
+			const u32 count = (cmd >> 18) & 0x7ff;
+
+			if ((cmd & RSX_METHOD_OLD_JUMP_CMD_MASK) == RSX_METHOD_OLD_JUMP_CMD)
+			{
+				u32 offs = cmd & 0x1ffffffc;
+				//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
+				m_fetch_get = offs;
+				continue;
+			}
+			if ((cmd & RSX_METHOD_NEW_JUMP_CMD_MASK) == RSX_METHOD_NEW_JUMP_CMD)
+			{
+				u32 offs = cmd & 0xfffffffc;
+				//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
+				m_fetch_get = offs;
+				continue;
+			}
+			if ((cmd & RSX_METHOD_CALL_CMD_MASK) == RSX_METHOD_CALL_CMD)
+			{
+				m_call_stack.push(m_fetch_get + 4);
+				u32 offs = cmd & ~3;
+				//LOG_WARNING(RSX, "rsx call(0x%x) #0x%x - 0x%x", offs, cmd, get);
+				m_fetch_get = offs;
+				continue;
+			}
+			if (cmd == RSX_METHOD_RETURN_CMD)
+			{
+				u32 get = m_call_stack.top();
+				m_call_stack.pop();
+				//LOG_WARNING(RSX, "rsx return(0x%x)", get);
+				m_fetch_get = get;
+				continue;
+			}
+			if (cmd == 0) //nop
+			{
+				m_fetch_get += 4;
+				continue;
+			}
+
+			//Validate the args ptr if the command attempts to read from it
+			const u32 args_address = RSXIOMem.RealAddr(m_fetch_get + 4);
+
+			if (!args_address && count)
+			{
+				LOG_ERROR(RSX, "Invalid FIFO queue args ptr found, get=0x%X, cmd=0x%X, count=%d", m_fetch_get, cmd, count);
+
+				if (mem_faults_count >= 3)
+				{
+					LOG_ERROR(RSX, "Application has failed to recover, discarding FIFO queue");
+					m_fetch_get = put;
+				}
+				else
+				{
+					mem_faults_count++;
+					std::this_thread::sleep_for(1ms);
+				}
+
+				// Raise the invalid command interrupt on the RSX thread
+				send(0, 0, fifo_fault, 0);
+				continue;
+			}
+
+			// All good on valid memory ptrs
+			mem_faults_count = 0;
+
+			const u32 first_cmd = (cmd & 0xfffc) >> 2;
+			u32 flags = 0;
+
+			if ((cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD)
+			{
+				flags |= fifo_non_increment;
+			}
+
+			if (cmd & 0x3)
+			{
+				LOG_WARNING(RSX, "unaligned command: %s (0x%x from 0x%x)", get_method_name(first_cmd).c_str(), first_cmd, cmd & 0xffff);
+				flags |= fifo_unaligned;
+			}
+
+			m_fetch_get += (count + 1) * 4;
+
+			if (!send(first_cmd, count, flags, args_address))
+			{
 				continue;
 			}
 
-			internal_get += (count + 1) * 4;
+			if (count && (flags & fifo_non_increment ? first_cmd == NV406E_SEMAPHORE_ACQUIRE : first_cmd <= NV406E_SEMAPHORE_ACQUIRE && first_cmd + count > NV406E_SEMAPHORE_ACQUIRE))
+			{
+				barrier = true;
+			}
 		}
 	}
 
@@ -730,6 +937,12 @@ namespace rsx
 			m_vblank_thread->join();
 			m_vblank_thread.reset();
 		}
+
+		if (m_fifo_thread)
+		{
+			m_fifo_thread->join();
+			m_fifo_thread.reset();
+		}
 	}
 
 	std::string thread::get_name() const
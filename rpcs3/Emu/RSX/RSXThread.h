@@ -135,12 +135,47 @@ namespace rsx
 		std::array<attribute_buffer_placement, 16> attribute_placement;
 	};
 
+	enum fifo_packet_flags : u32
+	{
+		fifo_non_increment = 1,
+		fifo_unaligned = 2,
+		fifo_fault = 4, // Invalid get or args address found (no command)
+	};
+
+	// Method run fetched and validated by the FIFO thread
+	struct fifo_packet
+	{
+		u32 reg; // First method register
+		u32 count; // Argument count (0 if only the FIFO position is updated)
+		u32 get; // FIFO position after the command
+		u32 flags; // fifo_packet_flags
+		u64 args; // Position of the first argument in the argument ring
+	};
+
 	class thread : public named_thread
 	{
 		std::shared_ptr<thread_ctrl> m_vblank_thread;
+		std::shared_ptr<thread_ctrl> m_fifo_thread;
+
+		static constexpr u32 fifo_packets_size = 0x4000;
+		static constexpr u32 fifo_args_size = 0x40000;
+
+		// Packet and argument rings (written by the FIFO thread, read by the RSX thread)
+		std::unique_ptr<fifo_packet[]> m_fifo_packets;
+		std::unique_ptr<u32[]> m_fifo_args;
+		atomic_t<u64> m_fifo_put{0};
+		atomic_t<u64> m_fifo_get{0};
+		u64 m_fifo_args_put = 0;
+		atomic_t<u64> m_fifo_args_get{0};
+
+		// FIFO position of the FIFO thread
+		u32 m_fetch_get = 0;
+
+		// FIFO thread entry point: follow jumps and calls, validate commands and send them to the RSX thread
+		void fifo_fetch_task();
 
 	protected:
-		std::stack<u32> m_call_stack;
+		std::stack<u32> m_call_stack; // Used by the FIFO thread
 		std::array<push_buffer_vertex_info, 16> vertex_push_buffers;
 		std::vector<u32> element_push_buffer;
 
@@ -153,6 +188,9 @@ namespace rsx
 		RsxDmaControl* ctrl = nullptr;
 		atomic_t<u32> internal_get{ 0 };
 
+		// Pending FIFO position reset (1 << 32 | new get), pending commands are discarded
+		atomic_t<u64> fifo_reset{ 0 };
+
 		Timer timer_sync;
 
 		GcmTileInfo tiles[limits::tiles_count];
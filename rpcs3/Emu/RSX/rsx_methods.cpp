@@ -37,6 +37,7 @@ namespace rsx
 	rsx_state method_registers;
 	
 	std::array<rsx_method_t, 0x10000 / 4> methods{};
+	std::array<rsx_range_method_t, 0x10000 / 4> range_methods{};
 
 	void invalid_method(thread* rsx, u32 _reg, u32 arg)
 	{
@@ -296,6 +297,47 @@ namespace rsx
 			}
 		};
 
+		u32 set_transform_constant_range(thread* rsxthr, u32 reg, const u32* args, u32 count)
+		{
+			const u32 first = reg - NV4097_SET_TRANSFORM_CONSTANT;
+			const u32 last = first + std::min(count, 32 - first);
+
+			method_registers.decode_range(reg, args, last - first);
+
+			// Look up each constant once instead of once per component
+			const u32 load = method_registers.transform_constant_load();
+
+			for (u32 i = first; i < last;)
+			{
+				auto& constant = method_registers.transform_constants[load + i / 4];
+
+				do
+				{
+					constant.rgba[i % 4] = (const f32&)args[i - first];
+				}
+				while (++i % 4 && i < last);
+			}
+
+			rsxthr->m_transform_constants_dirty = true;
+			return last - first;
+		}
+
+		u32 set_transform_program_range(thread* rsx, u32 reg, const u32* args, u32 count)
+		{
+			const u32 first = reg - NV4097_SET_TRANSFORM_PROGRAM;
+			const u32 last = first + std::min(count, 512 - first);
+
+			method_registers.decode_range(reg, args, last - first);
+
+			// Commit every instruction completed by this run
+			for (u32 index = first / 4; index * 4 + 3 < last; index++)
+			{
+				method_registers.commit_4_transform_program_instructions(index);
+			}
+
+			return last - first;
+		}
+
 		void set_begin_end(thread* rsxthr, u32 _reg, u32 arg)
 		{
 			if (arg)
@@ -1090,6 +1132,11 @@ namespace rsx
 		registers[reg] = value;
 	}
 
+	void rsx_state::decode_range(u32 reg, const u32* args, u32 count)
+	{
+		std::memcpy(&registers[reg], args, count * sizeof(u32));
+	}
+
 	namespace method_detail
 	{
 		template<int Id, int Step, int Count, template<u32> class T, int Index = 0>
@@ -1122,6 +1169,15 @@ namespace rsx
 			methods[Id] = Func;
 		}
 
+		template<int Id, int Count, rsx_range_method_t Func>
+		static void bind_range_method()
+		{
+			for (int i = Id; i < Id + Count; i++)
+			{
+				range_methods[i] = Func;
+			}
+		}
+
 		template<int Id, int Step, int Count, rsx_method_t Func>
 		static void bind_array()
 		{
@@ -1514,6 +1570,8 @@ namespace rsx
 		bind_range<NV4097_SET_VERTEX_DATA4S_M, 1, 32, nv4097::set_vertex_data4s_m>();
 		bind_range<NV4097_SET_TRANSFORM_CONSTANT, 1, 32, nv4097::set_transform_constant>();
 		bind_range<NV4097_SET_TRANSFORM_PROGRAM + 3, 4, 128, nv4097::set_transform_program>();
+		bind_range_method<NV4097_SET_TRANSFORM_CONSTANT, 32, nv4097::set_transform_constant_range>();
+		bind_range_method<NV4097_SET_TRANSFORM_PROGRAM, 512, nv4097::set_transform_program_range>();
 		bind<NV4097_GET_REPORT, nv4097::get_report>();
 		bind<NV4097_CLEAR_REPORT_VALUE, nv4097::clear_report_value>();
 		bind<NV4097_SET_SURFACE_CLIP_HORIZONTAL, nv4097::set_surface_dirty_bit>();
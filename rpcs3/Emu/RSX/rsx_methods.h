@@ -55,6 +55,9 @@ namespace rsx
 
 	using rsx_method_t = void(*)(class thread*, u32 reg, u32 arg);
 
+	// Handles an incrementing run of arguments starting at reg, returns the number of registers consumed
+	using rsx_range_method_t = u32(*)(class thread*, u32 reg, const u32* args, u32 count);
+
 	//TODO
 	union alignas(4) method_registers_t
 	{
@@ -189,6 +192,8 @@ namespace rsx
 
 		void decode(u32 reg, u32 value);
 
+		void decode_range(u32 reg, const u32* args, u32 count);
+
 		void reset();
 
 		template<typename Archive>
@@ -1175,4 +1180,5 @@ namespace rsx
 
 	extern rsx_state method_registers;
 	extern std::array<rsx_method_t, 0x10000 / 4> methods;
+	extern std::array<rsx_range_method_t, 0x10000 / 4> range_methods;
 }
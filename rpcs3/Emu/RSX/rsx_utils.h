@@ -67,80 +67,184 @@ namespace rsx
 		return value <= 1 ? 0 : ::cntlz32((value - 1) << 1, true) ^ 31;
 	}
 
-	/*   Note: What the ps3 calls swizzling in this case is actually z-ordering / morton ordering of pixels
-	*       - Input can be swizzled or linear, bool flag handles conversion to and from
-	*       - It will handle any width and height that are a power of 2, square or non square
-	*	 Restriction: It has mixed results if the height or width is not a power of 2
+	// Spread the low 16 bits of value to the even bit positions
+	static inline u32 interleave_bits(u32 value)
+	{
+		value = (value | (value << 8)) & 0x00FF00FF;
+		value = (value | (value << 4)) & 0x0F0F0F0F;
+		value = (value | (value << 2)) & 0x33333333;
+		value = (value | (value << 1)) & 0x55555555;
+		return value;
+	}
+
+	/* Swizzled offset of column x / row y, log2_square being the log2 of the largest square block (the smaller dimension).
+	*  Coordinates inside the square are interleaved (x on even bits, y on odd bits), blocks are stacked along the larger dimension.
+	*  offset(x, y) = get_swizzle_offset_x(x) + get_swizzle_offset_y(y)
 	*/
-	template<typename T>
-	void convert_linear_swizzle(void* input_pixels, void* output_pixels, u16 width, u16 height, bool input_is_swizzled)
+	static inline u32 get_swizzle_offset_x(u32 x, u32 log2_square)
 	{
-		u32 log2width = ceil_log2(width);
-		u32 log2height = ceil_log2(height);
+		return interleave_bits(x & ((1 << log2_square) - 1)) + static_cast<u32>(u64{x >> log2_square} << (log2_square * 2));
+	}
 
-		// Max mask possible for square texture
-		u32 x_mask = 0x55555555;
-		u32 y_mask = 0xAAAAAAAA;
+	static inline u32 get_swizzle_offset_y(u32 y, u32 log2_square)
+	{
+		return (interleave_bits(y & ((1 << log2_square) - 1)) << 1) + static_cast<u32>(u64{y >> log2_square} << (log2_square * 2));
+	}
+
+	// Convert a 4x4 texel tile, stored as 16 contiguous texels once swizzled (four 2x2 blocks of two texel pairs each)
+	template<typename T, bool input_is_swizzled>
+	static inline void convert_linear_swizzle_tile(T* linear, u32 pitch, T* swizzled)
+	{
+		if (sizeof(T) == 1)
+		{
+			// Swap the middle texel pairs of each 2x2 block
+			u32 rows[4];
+
+			if (!input_is_swizzled)
+			{
+				for (u32 y = 0; y < 4; y++)
+					std::memcpy(rows + y, linear + y * pitch, 4);
+
+				const __m128i lo = _mm_unpacklo_epi32(_mm_cvtsi32_si128(rows[0]), _mm_cvtsi32_si128(rows[1]));
+				const __m128i hi = _mm_unpacklo_epi32(_mm_cvtsi32_si128(rows[2]), _mm_cvtsi32_si128(rows[3]));
+				__m128i tile = _mm_unpacklo_epi64(lo, hi);
+				tile = _mm_shufflehi_epi16(_mm_shufflelo_epi16(tile, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(swizzled), tile);
+			}
+			else
+			{
+				__m128i tile = _mm_loadu_si128(reinterpret_cast<__m128i*>(swizzled));
+				tile = _mm_shufflehi_epi16(_mm_shufflelo_epi16(tile, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
 
-		// We have to limit the masks to the lower of the two dimensions to allow for non-square textures
-		u32 limit_mask = (log2width < log2height) ? log2width : log2height;
-		// double the limit mask to account for bits in both x and y
-		limit_mask = 1 << (limit_mask << 1);
+				for (u32 y = 0; y < 4; y++)
+				{
+					rows[y] = _mm_cvtsi128_si32(tile);
+					tile = _mm_srli_si128(tile, 4);
+				}
 
-		//x_mask, bits above limit are 1's for x-carry
-		x_mask = (x_mask | ~(limit_mask - 1));
-		//y_mask. bits above limit are 0'd, as we use a different method for y-carry over
-		y_mask = (y_mask & (limit_mask - 1));
+				for (u32 y = 0; y < 4; y++)
+					std::memcpy(linear + y * pitch, rows + y, 4);
+			}
 
-		u32 offs_y = 0;
-		u32 offs_x = 0;
-		u32 offs_x0 = 0; //total y-carry offset for x
-		u32 y_incr = limit_mask;
+			return;
+		}
 
-		if (!input_is_swizzled)
+		if (sizeof(T) == 2)
 		{
-			for (int y = 0; y < height; ++y)
+			for (u32 y = 0; y < 4; y += 2)
 			{
-				T *src = static_cast<T*>(input_pixels) + y * width;
-				T *dst = static_cast<T*>(output_pixels) + offs_y;
-				offs_x = offs_x0;
+				__m128i* row0 = reinterpret_cast<__m128i*>(linear + y * pitch);
+				__m128i* row1 = reinterpret_cast<__m128i*>(linear + (y + 1) * pitch);
+				__m128i* tile = reinterpret_cast<__m128i*>(swizzled + y * 4);
 
-				for (int x = 0; x < width; ++x)
+				if (!input_is_swizzled)
 				{
-					dst[offs_x] = src[x];
-					offs_x = (offs_x - x_mask) & x_mask;
+					const __m128i rows = _mm_unpacklo_epi64(_mm_loadl_epi64(row0), _mm_loadl_epi64(row1));
+					_mm_storeu_si128(tile, _mm_shuffle_epi32(rows, _MM_SHUFFLE(3, 1, 2, 0)));
 				}
-
-				offs_y = (offs_y - y_mask) & y_mask;
-
-				if (offs_y == 0)
+				else
 				{
-					offs_x0 += y_incr;
+					const __m128i rows = _mm_shuffle_epi32(_mm_loadu_si128(tile), _MM_SHUFFLE(3, 1, 2, 0));
+					_mm_storel_epi64(row0, rows);
+					_mm_storel_epi64(row1, _mm_unpackhi_epi64(rows, rows));
 				}
 			}
+
+			return;
 		}
-		else
+
+		if (sizeof(T) == 4)
 		{
-			for (int y = 0; y < height; ++y)
+			// Interleave 64-bit halves of two rows
+			for (u32 y = 0; y < 4; y += 2)
 			{
-				T *src = static_cast<T*>(input_pixels) + offs_y;
-				T *dst = static_cast<T*>(output_pixels) + y * width;
-				offs_x = offs_x0;
+				__m128i* row0 = reinterpret_cast<__m128i*>(linear + y * pitch);
+				__m128i* row1 = reinterpret_cast<__m128i*>(linear + (y + 1) * pitch);
+				__m128i* tile = reinterpret_cast<__m128i*>(swizzled + y * 4);
 
-				for (int x = 0; x < width; ++x)
+				if (!input_is_swizzled)
 				{
-					dst[x] = src[offs_x];
-					offs_x = (offs_x - x_mask) & x_mask;
+					const __m128i r0 = _mm_loadu_si128(row0);
+					const __m128i r1 = _mm_loadu_si128(row1);
+					_mm_storeu_si128(tile, _mm_unpacklo_epi64(r0, r1));
+					_mm_storeu_si128(tile + 1, _mm_unpackhi_epi64(r0, r1));
 				}
-
-				offs_y = (offs_y - y_mask) & y_mask;
-
-				if (offs_y == 0)
+				else
 				{
-					offs_x0 += y_incr;
+					const __m128i t0 = _mm_loadu_si128(tile);
+					const __m128i t1 = _mm_loadu_si128(tile + 1);
+					_mm_storeu_si128(row0, _mm_unpacklo_epi64(t0, t1));
+					_mm_storeu_si128(row1, _mm_unpackhi_epi64(t0, t1));
 				}
 			}
+
+			return;
 		}
+
+		for (u32 block = 0; block < 4; block++)
+		{
+			for (u32 row = 0; row < 2; row++)
+			{
+				T* pair = linear + ((block >> 1) * 2 + row) * pitch + (block & 1) * 2;
+				T* dst = swizzled + block * 4 + row * 2;
+
+				if (!input_is_swizzled)
+					std::memcpy(dst, pair, sizeof(T) * 2);
+				else
+					std::memcpy(pair, dst, sizeof(T) * 2);
+			}
+		}
+	}
+
+	/*   Note: What the ps3 calls swizzling in this case is actually z-ordering / morton ordering of pixels
+	*       - Input can be swizzled or linear, bool flag handles conversion to and from
+	*       - It will handle any width and height that are a power of 2, square or non square
+	*	 Restriction: It has mixed results if the height or width is not a power of 2
+	*       - Whole 4x4 tiles are converted with SSE2 shuffles, remaining edge texels one at a time
+	*/
+	template<typename T, bool input_is_swizzled>
+	void convert_linear_swizzle_impl(T* linear, T* swizzled, u16 width, u16 height)
+	{
+		const u32 log2_square = std::min(ceil_log2(width), ceil_log2(height));
+
+		// Area covered by whole 4x4 tiles
+		const u32 tiled_width = log2_square >= 2 ? width & ~3 : 0;
+		const u32 tiled_height = log2_square >= 2 ? height & ~3 : 0;
+
+		for (u32 y = 0; y < tiled_height; y += 4)
+		{
+			T* row = linear + y * width;
+			T* tiles = swizzled + get_swizzle_offset_y(y, log2_square);
+
+			for (u32 x = 0; x < tiled_width; x += 4)
+			{
+				convert_linear_swizzle_tile<T, input_is_swizzled>(row + x, width, tiles + get_swizzle_offset_x(x, log2_square));
+			}
+		}
+
+		// Remaining texels on the right and bottom edges
+		for (u32 y = 0; y < height; ++y)
+		{
+			T* row = linear + y * width;
+			T* texels = swizzled + get_swizzle_offset_y(y, log2_square);
+
+			for (u32 x = y < tiled_height ? tiled_width : 0; x < width; ++x)
+			{
+				if (!input_is_swizzled)
+					texels[get_swizzle_offset_x(x, log2_square)] = row[x];
+				else
+					row[x] = texels[get_swizzle_offset_x(x, log2_square)];
+			}
+		}
+	}
+
+	template<typename T>
+	void convert_linear_swizzle(void* input_pixels, void* output_pixels, u16 width, u16 height, bool input_is_swizzled)
+	{
+		if (!input_is_swizzled)
+			convert_linear_swizzle_impl<T, false>(static_cast<T*>(input_pixels), static_cast<T*>(output_pixels), width, height);
+		else
+			convert_linear_swizzle_impl<T, true>(static_cast<T*>(output_pixels), static_cast<T*>(input_pixels), width, height);
 	}
 
 	void scale_image_nearest(void* dst, const void* src, u16 src_width, u16 src_height, u16 dst_pitch, u16 src_pitch, u8 pixel_size, u8 samples, bool swap_bytes = false);
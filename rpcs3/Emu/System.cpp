@@ -350,6 +350,9 @@ void Emulator::Load(bool add_only)
 
 		LOG_NOTICE(LOADER, "Used configuration:\n%s\n", g_cfg.to_string());
 
+		// Format log messages on the background thread if requested
+		logs::set_async(g_cfg.misc.async_log);
+
 		// Load patches from different locations
 		fxm::check_unlocked<patch_engine>()->append(fs::get_config_dir() + "data/" + m_title_id + "/patch.yml");
 		fxm::check_unlocked<patch_engine>()->append(m_cache_path + "/patch.yml");
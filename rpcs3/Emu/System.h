@@ -271,17 +271,21 @@ struct cfg_root : cfg::node
 		cfg::_enum<ppu_decoder_type> ppu_decoder{this, "PPU Decoder", ppu_decoder_type::llvm};
 		cfg::_int<1, 16> ppu_threads{this, "PPU Threads", 2}; // Amount of PPU threads running simultaneously (must be 2)
 		cfg::_bool ppu_debug{this, "PPU Debug"};
+		cfg::_bool ppu_superblocks{this, "PPU Interpreter Superblocks"}; // Pre-decode straight-line runs of instructions for the interpreters
 		cfg::_bool llvm_logs{this, "Save LLVM logs"};
 		cfg::string llvm_cpu{this, "Use LLVM CPU"};
+		cfg::_int<0, 0x10000000> ppu_hot_threshold{this, "PPU Hot Function Threshold", 0}; // Function entries before recompilation with full optimizations (0: disabled)
 
 		cfg::_enum<spu_decoder_type> spu_decoder{this, "SPU Decoder", spu_decoder_type::asmjit};
 		cfg::_bool bind_spu_cores{this, "Bind SPU threads to secondary cores"};
 		cfg::_bool lower_spu_priority{this, "Lower SPU thread priority"};
 		cfg::_bool spu_debug{this, "SPU Debug"};
+		cfg::_int<0, 16> spu_compiler_threads{this, "SPU Compiler Threads", 0}; // Background SPU compiler threads (0: compile on the SPU thread before execution)
 		cfg::_int<32, 16384> max_spu_immediate_write_size{this, "Maximum immediate DMA write size", 16384}; // Maximum size that an SPU thread can write directly without posting to MFC
 		cfg::_int<0, 6> preferred_spu_threads{this, "Preferred SPU Threads", 0}; //Numnber of hardware threads dedicated to heavy simultaneous spu tasks
 		cfg::_int<0, 16> spu_delay_penalty{this, "SPU delay penalty", 3}; //Number of milliseconds to block a thread if a virtual 'core' isn't free
 		cfg::_bool spu_loop_detection{this, "SPU loop detection", true}; //Try to detect wait loops and trigger thread yield
+		cfg::_int<0, 5000> lv2_timer_spin{this, "LV2 Timer Spin Time", 200}; // Microseconds before a timeout when the timer thread stops sleeping and spins (0: sleep only)
 
 		cfg::_enum<lib_loading_type> lib_loading{this, "Lib Loader", lib_loading_type::liblv2only};
 		cfg::_bool hook_functions{this, "Hook static functions"};
@@ -408,6 +412,7 @@ struct cfg_root : cfg::node
 		cfg::_bool show_fps_in_title{ this, "Show FPS counter in window title", true};
 		cfg::_bool show_trophy_popups{ this, "Show trophy popups", true};
 		cfg::_int<1, 65535> gdb_server_port{this, "Port", 2345};
+		cfg::_bool async_log{this, "Asynchronous logging"};
 
 	} misc{this};
 
@@ -2,18 +2,40 @@
 #include "IdManager.h"
 #include "VFS.h"
 
-#include <regex>
-
 struct vfs_manager
 {
 	shared_mutex mutex;
 
 	// Device name -> Real path
 	std::unordered_map<std::string, std::string> mounted;
+
+	vfs_manager();
+	~vfs_manager();
+};
+
+// Incremented on every change of the mount table (invalidates resolved path caches)
+static atomic_t<u64> s_vfs_generation{0};
+
+vfs_manager::vfs_manager()
+{
+	s_vfs_generation++;
+}
+
+vfs_manager::~vfs_manager()
+{
+	s_vfs_generation++;
+}
+
+// Recently resolved paths (direct-mapped, per thread)
+struct vfs_cache_entry
+{
+	u64 generation = UINT64_MAX;
+	vfs::type type;
+	std::string vpath;
+	std::string result;
 };
 
-const std::regex s_regex_ps3("^/+(.*?)(?:$|/)(.*)", std::regex::optimize);
-const std::regex s_regex_psv("^(.*?):(.*)", std::regex::optimize);
+static thread_local vfs_cache_entry s_vfs_cache[64];
 
 bool vfs::mount(const std::string& dev_name, const std::string& path)
 {
@@ -21,18 +43,42 @@ bool vfs::mount(const std::string& dev_name, const std::string& path)
 
 	writer_lock lock(table->mutex);
 
-	return table->mounted.emplace(dev_name, path).second;
+	if (table->mounted.emplace(dev_name, path).second)
+	{
+		s_vfs_generation++;
+		return true;
+	}
+
+	return false;
 }
 
-std::string vfs::get(const std::string& vpath, vfs::type _type)
+static std::string vfs_get(const std::string& vpath, vfs::type _type)
 {
 	const auto table = fxm::get_always<vfs_manager>();
 
 	reader_lock lock(table->mutex);
 
-	std::smatch match;
+	// Split device name and the rest of the path: "/+dev(/path)?" (PS3) or "dev:path" (PSV)
+	std::size_t dev_pos = 0, dev_end = std::string::npos, path_pos = 0;
+
+	if (_type == vfs::type::ps3)
+	{
+		if (!vpath.empty() && vpath[0] == '/')
+		{
+			dev_pos = vpath.find_first_not_of('/');
+			dev_pos = dev_pos == std::string::npos ? vpath.size() : dev_pos;
+			dev_end = vpath.find_first_of('/', dev_pos);
+			dev_end = dev_end == std::string::npos ? vpath.size() : dev_end;
+			path_pos = dev_end == vpath.size() ? dev_end : dev_end + 1;
+		}
+	}
+	else
+	{
+		dev_end = vpath.find_first_of(':');
+		path_pos = dev_end + 1;
+	}
 
-	if (!std::regex_match(vpath, match, _type == type::ps3 ? s_regex_ps3 : s_regex_psv))
+	if (dev_end == std::string::npos)
 	{
 		const auto found = table->mounted.find("");
 
@@ -45,12 +91,12 @@ std::string vfs::get(const std::string& vpath, vfs::type _type)
 		return found->second + vfs::escape(vpath);
 	}
 
-	if (_type == type::ps3 && match.length(1) == 0)
+	if (_type == vfs::type::ps3 && dev_end == dev_pos)
 	{
 		return "/";
 	}
 
-	const auto found = table->mounted.find(match.str(1));
+	const auto found = table->mounted.find(vpath.substr(dev_pos, dev_end - dev_pos));
 
 	if (found == table->mounted.end())
 	{
@@ -61,16 +107,46 @@ std::string vfs::get(const std::string& vpath, vfs::type _type)
 	if (found->second.empty())
 	{
 		// Don't escape /host_root (TODO)
-		return match.str(2);
+		return vpath.substr(path_pos);
 	}
 
 	// Escape and concatenate
-	return found->second + vfs::escape(match.str(2));
+	return found->second + vfs::escape(vpath.substr(path_pos));
 }
 
+std::string vfs::get(const std::string& vpath, vfs::type _type)
+{
+	const u64 generation = s_vfs_generation;
+
+	auto& entry = s_vfs_cache[std::hash<std::string>()(vpath) % 64];
+
+	if (entry.generation == generation && entry.type == _type && entry.vpath == vpath)
+	{
+		return entry.result;
+	}
+
+	std::string result = vfs_get(vpath, _type);
+
+	// Don't cache failures (they are logged)
+	if (!result.empty())
+	{
+		entry.generation = generation;
+		entry.type = _type;
+		entry.vpath = vpath;
+		entry.result = result;
+	}
+
+	return result;
+}
 
 std::string vfs::escape(const std::string& path)
 {
+	// Fast path: nothing to escape
+	if (path.find_first_of("<>:\"\\|?*\xEF") == std::string::npos)
+	{
+		return path;
+	}
+
 	std::string result;
 	result.reserve(path.size());
 
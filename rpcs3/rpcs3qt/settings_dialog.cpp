@@ -206,6 +206,13 @@ settings_dialog::settings_dialog(std::shared_ptr<gui_settings> guiSettings, std:
 				spuBG->button(i)->setChecked(true);
 			}
 
+#ifndef LLVM_AVAILABLE
+			if (spu_list[i].toLower().contains("llvm"))
+			{
+				spuBG->button(i)->setEnabled(false);
+			}
+#endif
+
 			connect(spuBG->button(i), &QAbstractButton::pressed, [=]()
 			{
 				xemu_settings->SetSetting(emu_settings::SPUDecoder, sstr(spu_list[i]));